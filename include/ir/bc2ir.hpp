@@ -3,7 +3,9 @@
 #include <vm/function.hpp>
 
 namespace li::ir {
-	// Generates crude bytecode.
+	// Generates crude bytecode, returns null if the function uses an opcode the JIT does not support yet.
+	// If an OSR entry is given, the procedure instead starts at that bytecode position with all locals
+	// read from the frame of the interpreter.
 	//
-	std::unique_ptr<procedure> lift_bc(vm* L, function_proto* f);
+	std::unique_ptr<procedure> lift_bc(vm* L, function_proto* f, bc::pos osr_entry = bc::no_pos);
 };
\ No newline at end of file
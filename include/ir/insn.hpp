@@ -59,6 +59,10 @@ namespace li::ir {
 		select,
 		phi,
 
+		// Interpreter state for deoptimization, not allowed at MIR.
+		//
+		frame_state,
+
 		// VCALL utilities.
 		//
 		set_exception,
@@ -77,6 +81,7 @@ namespace li::ir {
 		// Procedure terminators.
 		//
 		ret,
+		deopt,
 		unreachable,
 	};
 
@@ -372,6 +377,27 @@ namespace li::ir {
 			LI_ASSERT(operands.size() == 1);
 		}
 	};
+	// none   deopt(i32 bc, i32 reg, unk... values)
+	struct deopt final : insn_tag<deopt, opcode::deopt> {
+		void update() override {
+			sideffect = true;
+			vt        = type::none;
+			LI_ASSERT(operands.size() >= 2);
+			LI_ASSERT(operands[0]->is<constant>() && operands[0]->is(type::i32));
+			LI_ASSERT(operands[1]->is<constant>() && operands[1]->is(type::i32));
+		}
+	};
+	// none   frame_state(i32 bc, i32 reg, unk... values)
+	struct frame_state final : insn_tag<frame_state, opcode::frame_state> {
+		void update() override {
+			is_pure     = false;
+			is_volatile = true;
+			vt          = type::none;
+			LI_ASSERT(operands.size() >= 2);
+			LI_ASSERT(operands[0]->is<constant>() && operands[0]->is(type::i32));
+			LI_ASSERT(operands[1]->is<constant>() && operands[1]->is(type::i32));
+		}
+	};
 	// none   unreachable()
 	struct unreachable final : insn_tag<unreachable, opcode::unreachable> {
 		void update() override {
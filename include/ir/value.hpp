@@ -328,6 +328,8 @@ namespace li::ir {
 				return any(fn);
 			} else if (vt == type::str) {
 				return any(str);
+			} else if (vt == type::omap || vt == type::tarr) {
+				return any(gc);
 			} else {
 				util::abort("cannot coerce %s to any", to_string().c_str());
 			}
@@ -121,6 +121,13 @@ namespace li::ir {
 	INSN_W_R_R(VMAXSD, .trashes_flags = false, );
 	INSN_RW_R(PCMPEQB, .trashes_flags = false, );
 	INSN_W_R_R(VPCMPEQB, .trashes_flags = false, );
+	INSN_RW_R(PUNPCKLQDQ, .trashes_flags = false, );
+	INSN_W_R_R(VPUNPCKLQDQ, .trashes_flags = false, );
+	INSN_W_R(MOVDQU, .trashes_flags = false, .force_size = 0x10, );
+	INSN_W_R(VMOVDQU, .trashes_flags = false, .force_size = 0x10, );
+	INSN_W_R(PMOVMSKB, .trashes_flags = false, );
+	INSN_W_R(VPMOVMSKB, .trashes_flags = false, );
+	INSN_W_R(BSF);
 	INSN_W_R_R(VDIVSD, .trashes_flags = false, );
 	INSN_W_R_R(VMULSD, .trashes_flags = false, );
 	INSN_W_R_R(VADDSD, .trashes_flags = false, );
@@ -56,6 +56,7 @@ namespace li {
 		//
 		uint32_t                                 next_label = label_flag;  // Next label id.
 		std::vector<std::pair<bc::rel, bc::pos>> label_map  = {};          // Maps label id to position.
+		bc::pos                                  last_target = bc::no_pos; // Last position a label or a fixed jump points at.
 
 		// Constructors.
 		//
@@ -125,11 +126,22 @@ namespace li {
 
 		// Sets a label.
 		//
-		void set_label_here(bc::rel l) { fn.label_map.emplace_back(l, bc::pos(fn.pc.size())); }
+		void set_label_here(bc::rel l) {
+			fn.last_target = bc::pos(fn.pc.size());
+			fn.label_map.emplace_back(l, fn.last_target);
+		}
 
 		// Helper for fixing jump targets.
 		//
-		void jump_here(bc::pos br) { fn.pc[br].a = msize_t(fn.pc.size()) - (br + 1); }
+		void jump_here(bc::pos br) {
+			fn.last_target = bc::pos(fn.pc.size());
+			fn.pc[br].a    = msize_t(fn.pc.size()) - (br + 1);
+		}
+
+		// Fuses a conditional jump into the comparison that produced the condition if its result is not
+		// used anywhere else, returns the position of the jump on success.
+		//
+		std::optional<bc::pos> fuse_jcc(const expression& cc, bool on_true, bc::rel target = 0);
 
 		// Gets the lexer.
 		//
@@ -287,11 +299,7 @@ namespace li {
 					auto tbl = scope.fn.scope_table;
 					if (kind == expr::exp && scope.fn.module_table)
 						tbl = scope.fn.module_table;
-					auto tmp = scope.alloc_reg(2);
-					scope.set_reg(tmp, any(tbl));
-					scope.set_reg(tmp + 1, any(env));
-					scope.emit(bc::TGETR, r, tmp + 1, tmp);
-					scope.free_reg(tmp, 2);
+					scope.emit(bc::GGET, r, tbl->add_global(scope.fn.L, env), scope.add_const(any(tbl)).first);
 					return;
 				}
 				case expr::idx:
@@ -365,12 +373,10 @@ namespace li {
 					auto tbl = scope.fn.scope_table;
 					if (kind == expr::exp && scope.fn.module_table)
 						tbl = scope.fn.module_table;
-					auto tmp = scope.alloc_reg(2);
 					auto val = value.to_anyreg(scope);
-					scope.set_reg(tmp, any(tbl));
-					scope.set_reg(tmp + 1, any(env));
-					scope.emit(bc::TSETR, tmp+1, val, tmp);
-					scope.reg_next = tmp;
+					scope.emit(bc::GSET, tbl->add_global(scope.fn.L, env), val, scope.add_const(any(tbl)).first);
+					if (value.kind != expr::reg)
+						scope.free_reg(val);
 					return;
 				}
 				case expr::idx: {
@@ -49,6 +49,9 @@ namespace li::lib {
 		extern util::native_function builtin_int;
 		extern util::native_function builtin_push;
 		extern util::native_function builtin_pop;
+		extern util::native_function builtin_push_front;
+		extern util::native_function builtin_pop_front;
+		extern util::native_function builtin_compact;
 		extern util::native_function builtin_null_function;
 
 		void register_builtin(vm* L);
@@ -63,12 +66,20 @@ namespace li::lib {
 	//
 	void register_debug(vm* L);
 
+	// Registers the array library.
+	//
+	void register_array(vm* L);
+
 #if LI_JIT
 	// Turns jit on or off.
 	//
-	void jit_on(vm* L, function* f, bool verbose);
+	bool jit_on(vm* L, function* f, bool verbose);
 	void jit_off(vm* L, function* f);
 
+	// Compiles an entry point continuing the function from the given loop header for on-stack replacement.
+	//
+	jfunction* jit_osr(vm* L, function* f, bc::pos pc, bool verbose);
+
 	// Registers the JIT library.
 	//
 	void register_jit(vm* L);
@@ -79,8 +90,10 @@ namespace li::lib {
 	static void register_std(vm* L) {
 		register_debug(L);
 		register_chrono(L);
+		register_array(L);
 #if LI_JIT
 		register_jit(L);
 #endif
+		util::freeze_modules(L);
 	}
 };
\ No newline at end of file
@@ -79,6 +79,12 @@
 // Add intrinsics.
 //
 #if LI_ARCH_X86
+	#if defined(__SSE2__) || LI_MSVC
+		#define LI_HAS_SSE2   1
+	#endif
+	#if defined(__AVX2__)
+		#define LI_HAS_AVX2   1
+	#endif
 	#if defined(__SSE4_2__) && LI_GNU
 		#define LI_HAS_CRC    1
 		#define _mm_crc32_u8  __builtin_ia32_crc32qi
@@ -122,6 +128,19 @@
 		#define LI_JIT 1
 	#endif
 #endif
+#ifndef LI_JIT_THRESHOLD
+	#define LI_JIT_THRESHOLD 1000
+#endif
+#ifndef LI_JIT_DEOPT_LIMIT
+	#define LI_JIT_DEOPT_LIMIT 64
+#endif
+#ifndef LI_THREADED_DISPATCH
+	#if LI_GNU && !LI_ARCH_WASM
+		#define LI_THREADED_DISPATCH 1
+	#else
+		#define LI_THREADED_DISPATCH 0
+	#endif
+#endif
 
 // Common macros.
 //
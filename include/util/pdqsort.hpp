@@ -0,0 +1,309 @@
+#pragma once
+#include <util/common.hpp>
+#include <algorithm>
+#include <bit>
+#include <utility>
+
+// Pattern-defeating quicksort by Orson Peters, adapted to pointer ranges.
+// - The branchy variant keeps every scan bounds checked so that an inconsistent comparator (such as one written in
+//   script) can only produce an unsorted result, never walk out of the range.
+// - The branchless variant uses the block partitioning of BlockQuicksort and requires a strict weak ordering.
+//
+namespace li::util {
+	namespace detail::pdq {
+		static constexpr size_t insertion_sort_threshold     = 24;
+		static constexpr size_t ninther_threshold            = 128;
+		static constexpr size_t partial_insertion_sort_limit = 8;
+		static constexpr size_t block_size                   = 64;
+
+		// Insertion sort, the partial variant gives up after moving too many elements.
+		//
+		template<typename T, typename C>
+		static void insertion_sort(T* begin, T* end, C& comp) {
+			if (begin == end)
+				return;
+			for (T* cur = begin + 1; cur != end; ++cur) {
+				T* sift   = cur;
+				T* sift_1 = cur - 1;
+				if (comp(*sift, *sift_1)) {
+					T tmp = *sift;
+					do {
+						*sift-- = *sift_1;
+					} while (sift != begin && comp(tmp, *--sift_1));
+					*sift = tmp;
+				}
+			}
+		}
+		template<typename T, typename C>
+		static bool partial_insertion_sort(T* begin, T* end, C& comp) {
+			if (begin == end)
+				return true;
+			size_t limit = 0;
+			for (T* cur = begin + 1; cur != end; ++cur) {
+				T* sift   = cur;
+				T* sift_1 = cur - 1;
+				if (comp(*sift, *sift_1)) {
+					T tmp = *sift;
+					do {
+						*sift-- = *sift_1;
+					} while (sift != begin && comp(tmp, *--sift_1));
+					*sift = tmp;
+					limit += cur - sift;
+				}
+				if (limit > partial_insertion_sort_limit)
+					return false;
+			}
+			return true;
+		}
+
+		// Median selection.
+		//
+		template<typename T, typename C>
+		static void sort2(T* a, T* b, C& comp) {
+			if (comp(*b, *a))
+				std::swap(*a, *b);
+		}
+		template<typename T, typename C>
+		static void sort3(T* a, T* b, T* c, C& comp) {
+			sort2(a, b, comp);
+			sort2(b, c, comp);
+			sort2(a, b, comp);
+		}
+
+		// Partitions [begin, end) around *begin with the elements equal to the pivot going to the right, returns the
+		// position of the pivot and whether or not the range was already partitioned.
+		//
+		template<typename T, typename C>
+		static std::pair<T*, bool> partition_right(T* begin, T* end, C& comp) {
+			T  pivot = *begin;
+			T* first = begin + 1;
+			T* last  = end - 1;
+			while (first <= last && comp(*first, pivot))
+				++first;
+			while (first <= last && !comp(*last, pivot))
+				--last;
+
+			bool already_partitioned = first > last;
+			while (first < last) {
+				std::swap(*first++, *last--);
+				while (first <= last && comp(*first, pivot))
+					++first;
+				while (first <= last && !comp(*last, pivot))
+					--last;
+			}
+
+			T* pivot_pos = first - 1;
+			*begin       = *pivot_pos;
+			*pivot_pos   = pivot;
+			return {pivot_pos, already_partitioned};
+		}
+		template<typename T>
+		static void swap_offsets(T* first, T* last, uint8_t* offsets_l, uint8_t* offsets_r, size_t num, bool use_swaps) {
+			if (use_swaps) {
+				for (size_t i = 0; i < num; ++i)
+					std::swap(first[offsets_l[i]], *(last - offsets_r[i]));
+			} else if (num > 0) {
+				T* l   = first + offsets_l[0];
+				T* r   = last - offsets_r[0];
+				T  tmp = *l;
+				*l     = *r;
+				for (size_t i = 1; i < num; ++i) {
+					l  = first + offsets_l[i];
+					*r = *l;
+					r  = last - offsets_r[i];
+					*l = *r;
+				}
+				*r = tmp;
+			}
+		}
+		template<typename T, typename C>
+		static std::pair<T*, bool> partition_right_branchless(T* begin, T* end, C& comp) {
+			T  pivot = *begin;
+			T* first = begin;
+			T* last  = end;
+
+			// The median of 3 guarantees both searches a sentinel, except for the right one if there is nothing on the left.
+			//
+			while (comp(*++first, pivot))
+				;
+			if (first - 1 == begin)
+				while (first < last && !comp(*--last, pivot))
+					;
+			else
+				while (!comp(*--last, pivot))
+					;
+
+			bool already_partitioned = first >= last;
+			if (!already_partitioned) {
+				std::swap(*first, *last);
+				++first;
+
+				// Collect the offsets of the misplaced elements in blocks without branching on the comparison, then swap them.
+				//
+				alignas(64) uint8_t offsets_l[block_size];
+				alignas(64) uint8_t offsets_r[block_size];
+				T*                  offsets_l_base = first;
+				T*                  offsets_r_base = last;
+				size_t              num_l = 0, num_r = 0, start_l = 0, start_r = 0;
+				while (first < last) {
+					size_t num_unknown = last - first;
+					size_t left_split  = num_l == 0 ? (num_r == 0 ? num_unknown / 2 : num_unknown) : 0;
+					size_t right_split = num_r == 0 ? (num_unknown - left_split) : 0;
+
+					size_t n = std::min(left_split, block_size);
+					for (size_t i = 0; i < n; ++i) {
+						offsets_l[num_l] = uint8_t(i);
+						num_l += !comp(*first, pivot);
+						++first;
+					}
+					n = std::min(right_split, block_size);
+					for (size_t i = 0; i < n; ++i) {
+						offsets_r[num_r] = uint8_t(i + 1);
+						num_r += comp(*--last, pivot);
+					}
+
+					size_t num = std::min(num_l, num_r);
+					swap_offsets(offsets_l_base, offsets_r_base, offsets_l + start_l, offsets_r + start_r, num, num_l == num_r);
+					num_l -= num;
+					num_r -= num;
+					start_l += num;
+					start_r += num;
+					if (num_l == 0) {
+						start_l        = 0;
+						offsets_l_base = first;
+					}
+					if (num_r == 0) {
+						start_r        = 0;
+						offsets_r_base = last;
+					}
+				}
+
+				// Move the leftovers of the unfinished block.
+				//
+				if (num_l) {
+					while (num_l--)
+						std::swap(offsets_l_base[offsets_l[start_l + num_l]], *--last);
+					first = last;
+				}
+				if (num_r) {
+					while (num_r--)
+						std::swap(*(offsets_r_base - offsets_r[start_r + num_r]), *first), ++first;
+					last = first;
+				}
+			}
+
+			T* pivot_pos = first - 1;
+			*begin       = *pivot_pos;
+			*pivot_pos   = pivot;
+			return {pivot_pos, already_partitioned};
+		}
+
+		// Partitions [begin, end) around *begin with the elements equal to the pivot going to the left, returns the
+		// position of the pivot.
+		//
+		template<typename T, typename C>
+		static T* partition_left(T* begin, T* end, C& comp) {
+			T  pivot = *begin;
+			T* first = begin + 1;
+			T* last  = end - 1;
+			while (first <= last && comp(pivot, *last))
+				--last;
+			while (first <= last && !comp(pivot, *first))
+				++first;
+			while (first < last) {
+				std::swap(*first++, *last--);
+				while (first <= last && comp(pivot, *last))
+					--last;
+				while (first <= last && !comp(pivot, *first))
+					++first;
+			}
+
+			T* pivot_pos = last;
+			*begin       = *pivot_pos;
+			*pivot_pos   = pivot;
+			return pivot_pos;
+		}
+
+		template<bool Branchless, typename T, typename C>
+		static void sort_loop(T* begin, T* end, C& comp, int bad_allowed, bool leftmost = true) {
+			while (true) {
+				size_t size = end - begin;
+				if (size < insertion_sort_threshold) {
+					insertion_sort(begin, end, comp);
+					return;
+				}
+
+				// Choose the pivot as the median of 3 or the pseudomedian of 9.
+				//
+				size_t s2 = size / 2;
+				if (size > ninther_threshold) {
+					sort3(begin, begin + s2, end - 1, comp);
+					sort3(begin + 1, begin + (s2 - 1), end - 2, comp);
+					sort3(begin + 2, begin + (s2 + 1), end - 3, comp);
+					sort3(begin + (s2 - 1), begin + s2, begin + (s2 + 1), comp);
+					std::swap(*begin, *(begin + s2));
+				} else {
+					sort3(begin + s2, begin, end - 1, comp);
+				}
+
+				// If the pivot is equal to the pivot of the parent partition, everything equal to it is already in place.
+				//
+				if (!leftmost && !comp(*(begin - 1), *begin)) {
+					begin = partition_left(begin, end, comp) + 1;
+					continue;
+				}
+
+				auto [pivot_pos, already_partitioned] = Branchless ? partition_right_branchless(begin, end, comp) : partition_right(begin, end, comp);
+
+				// Shuffle highly unbalanced partitions to break patterns, falling back to heapsort if it keeps happening.
+				//
+				size_t l_size = pivot_pos - begin;
+				size_t r_size = end - (pivot_pos + 1);
+				if (l_size < size / 8 || r_size < size / 8) {
+					if (--bad_allowed == 0) {
+						std::make_heap(begin, end, comp);
+						std::sort_heap(begin, end, comp);
+						return;
+					}
+					if (l_size >= insertion_sort_threshold) {
+						std::swap(*begin, *(begin + l_size / 4));
+						std::swap(*(pivot_pos - 1), *(pivot_pos - l_size / 4));
+						if (l_size > ninther_threshold) {
+							std::swap(*(begin + 1), *(begin + (l_size / 4 + 1)));
+							std::swap(*(begin + 2), *(begin + (l_size / 4 + 2)));
+							std::swap(*(pivot_pos - 2), *(pivot_pos - (l_size / 4 + 1)));
+							std::swap(*(pivot_pos - 3), *(pivot_pos - (l_size / 4 + 2)));
+						}
+					}
+					if (r_size >= insertion_sort_threshold) {
+						std::swap(*(pivot_pos + 1), *(pivot_pos + (1 + r_size / 4)));
+						std::swap(*(end - 1), *(end - r_size / 4));
+						if (r_size > ninther_threshold) {
+							std::swap(*(pivot_pos + 2), *(pivot_pos + (2 + r_size / 4)));
+							std::swap(*(pivot_pos + 3), *(pivot_pos + (3 + r_size / 4)));
+							std::swap(*(end - 2), *(end - (1 + r_size / 4)));
+							std::swap(*(end - 3), *(end - (2 + r_size / 4)));
+						}
+					}
+				} else if (already_partitioned && partial_insertion_sort(begin, pivot_pos, comp) && partial_insertion_sort(pivot_pos + 1, end, comp)) {
+					return;
+				}
+
+				// Recurse into the left partition and loop on the right one.
+				//
+				sort_loop<Branchless>(begin, pivot_pos, comp, bad_allowed, leftmost);
+				begin    = pivot_pos + 1;
+				leftmost = false;
+			}
+		}
+	};
+
+	// Sorts [begin, end) with the given comparator.
+	//
+	template<bool Branchless = false, typename T, typename C>
+	static void pdqsort(T* begin, T* end, C comp) {
+		if (begin == end)
+			return;
+		detail::pdq::sort_loop<Branchless>(begin, end, comp, std::bit_width(size_t(end - begin)));
+	}
+};
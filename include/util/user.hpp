@@ -38,6 +38,17 @@ namespace li::util {
 		return vf;
 	}
 
+	// Rebuilds the module table and the library namespaces in it for constant lookups, should be called
+	// once the libraries are registered, later exports are still valid but lose the fast path.
+	//
+	static void freeze_modules(vm* L) {
+		for (auto& [k, v] : *L->modules) {
+			if (v.is_tbl() && v.as_tbl()->is_frozen)
+				v.as_tbl()->freeze(L);
+		}
+		L->modules->freeze(L);
+	}
+
 	// Native function wrapper.
 	//
 	struct native_function : function {
@@ -12,10 +12,13 @@ namespace li {
 
 		array_store* storage = nullptr;
 		msize_t      length  = 0;
-		any*         begin() { return storage ? storage->entries : nullptr; }
+		msize_t      head    = 0;  // Index of the first element in the storage, leaves room for pushing to the front.
+		msize_t      origin  = 0;  // Elements popped from the front less the ones pushed to it, wraps around.
+		any*         begin() { return storage ? storage->entries + head : nullptr; }
 		any*         end() { return begin() + size(); }
 		msize_t      size() const { return length; }
-		msize_t      capacity() const { return storage ? msize_t(storage->object_bytes() / sizeof(any)) : 0; }
+		msize_t      slots() const { return storage ? msize_t(storage->object_bytes() / sizeof(any)) : 0; }
+		msize_t      capacity() const { return slots() - head; }
 
 		// Duplicates the array.
 		//
@@ -42,6 +45,17 @@ namespace li {
 		//
 		any pop();
 
+		// Push-front and pop-front, amortized constant time.
+		//
+		void push_front(vm* L, any value);
+		any  pop_front();
+
+		// Inserts the values before the given index, removes n elements starting at the given index.
+		// - Both return false if the index is out of boundaries, remove clamps the count.
+		//
+		bool insert(vm* L, msize_t idx, const any* values, msize_t n);
+		bool remove(msize_t idx, msize_t n);
+
 		// Get/set.
 		// - Set returns false if it should throw because of out-of-boundaries index.
 		//
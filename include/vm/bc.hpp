@@ -63,10 +63,13 @@ namespace li::bc {
 	/* Table/Array operators. */                                                    \
 	_(ANEW, reg, imm, ___)  /* A=ARRAY{Size=B} */                                   \
 	_(TNEW, reg, imm, ___)  /* A=TABLE{Reserved=B} */                               \
+	_(TDUP, reg, kvl, ___)  /* A=Duplicate(KVAL[B]) */                              \
 	_(TGET, reg, reg, reg)  /* A=C[B] */                                            \
 	_(TSET, reg, reg, reg)  /* C[A]=B */                                            \
 	_(TGETR, reg, reg, reg) /* A=C[B] | Raw */                                      \
 	_(TSETR, reg, reg, reg) /* C[A]=B | Raw */                                      \
+	_(GGET, reg, imm, kvl)  /* A=KVAL[C].GLOBALS[B] | Raw */                        \
+	_(GSET, imm, reg, kvl)  /* KVAL[C].GLOBALS[A]=B | Raw */                        \
                                                                                    \
 	/* Closure operators. */                                                        \
 	_(FDUP, reg, kvl, reg) /* A=Duplicate(KVAL[B]), A.UVAL[0]=C, A.UVAL[1]=C+1.. */ \
@@ -80,11 +83,20 @@ namespace li::bc {
                                                                                    \
 	/* Control flow. */                                                             \
 	_(CALL, reg, imm, ___) /* A=Call(w/ B Args) */                                  \
+	_(TCALL, ___, imm, ___) /* RETURN Call(w/ B Args) */                              \
 	_(RET, reg, ___, ___)  /* RETURN A */                                           \
 	_(JMP, rel, ___, ___)  /* JMP A */                                              \
 	_(JS, rel, reg, ___)   /* JMP A if B */                                         \
 	_(JNS, rel, reg, ___)  /* JMP A if !B */                                        \
-	_(ITER, rel, reg, reg) /* B[1,2]=C[B++].kv, JMP A if end */                                                 
+	_(JEQ, rel, reg, reg)  /* JMP A if B==C */                                      \
+	_(JNE, rel, reg, reg)  /* JMP A if B!=C */                                      \
+	_(JLT, rel, reg, reg)  /* JMP A if B<C */                                       \
+	_(JLE, rel, reg, reg)  /* JMP A if B<=C */                                      \
+	_(JNLT, rel, reg, reg) /* JMP A if !(B<C) */                                    \
+	_(JNLE, rel, reg, reg) /* JMP A if !(B<=C) */                                   \
+	_(FORPREP, rel, reg, imm) /* Check B..B+2, JMP A if !(B<B+1), <= if C */        \
+	_(FORLOOP, rel, reg, imm) /* B+=B+2, JMP A if B<B+1, <= if C */                 \
+	_(ITER, rel, reg, reg)    /* B[1,2]=C[B++].kv, JMP A if end */
 
 	// Opcodes.
 	//
@@ -115,6 +127,10 @@ namespace li::bc {
 	};
 	static const desc& opcode_details(opcode o) { return opcode_descs[uint8_t(o)]; }
 
+	// Field accesses, each is assigned its own inline-cache slot when the prototype is created.
+	//
+	static constexpr bool is_field_access(opcode o) { return o == TGET || o == TSET || o == TGETR || o == TSETR; }
+
 	// Define the instruction type.
 	//
 #pragma pack(push, 1)
@@ -229,4 +245,5 @@ namespace li::bc {
 		}
 	};
 #pragma pack(pop)
+	static_assert(sizeof(insn) == 13, "Instructions are fetched on every dispatch, keep them packed.");
 };
@@ -15,7 +15,8 @@ namespace li {
 	_(sideeffect)   /*True if function has sideeffects, same definition as in ir::insn.*/ \
 	_(inline)       /*True if we should try inlining more aggressively.*/                 \
 	_(c_takes_self) /*True if first value in args array is describing the self.*/         \
-	_(c_takes_vm)   /*True if function should be called with a VM pointer.*/\
+	_(c_takes_vm)   /*True if function should be called with a VM pointer.*/          \
+	_(no_jit)       /*True if the JIT failed to compile the function, keeps it interpreted.*/\
 
 	enum functrion_attributes : uint32_t {
 		#define ENUM_AS_ID(x)   LI_STRCAT(func_attr_index_, x),
@@ -47,6 +48,7 @@ namespace li {
 
 	// VM function prototype.
 	//
+	struct table_entry;
 	struct line_info {
 		msize_t ip : 18         = 0;
 		msize_t line_delta : 14 = 0;
@@ -54,24 +56,45 @@ namespace li {
 	struct function_proto : gc::node<function_proto, type_gc_proto> {
 		static function_proto* create(vm* L, std::span<const bc::insn> opcodes, std::span<const any> kval, std::span<const line_info> lines);
 
-		uint32_t   attr          = func_attr_default;  // Function attributes.
-		msize_t    length        = 0;                  // Bytecode length.
-		msize_t    num_locals    = 0;                  // Number of local variables we need to reserve on stack.
-		msize_t    num_kval      = 0;                  // Number of constants.
-		msize_t    num_lines     = 0;                  // Number of lines in the line tab
-		msize_t    num_uval      = 0;                  // Number of upvalues.le.
-		msize_t    src_line      = 0;                  // Line of definition.
-		string*    src_chunk     = nullptr;            // Source of definition (chunk:function_name or chunk).
-		jfunction* jfunc         = nullptr;            // JIT function if there is one.
+		uint32_t   attr           = func_attr_default;  // Function attributes.
+		msize_t    length         = 0;                  // Bytecode length.
+		msize_t    num_locals     = 0;                  // Number of local variables we need to reserve on stack.
+		msize_t    num_kval       = 0;                  // Number of constants.
+		msize_t    num_lines      = 0;                  // Number of lines in the line tab
+		msize_t    num_uval       = 0;                  // Number of upvalues.le.
+		msize_t    num_icache     = 0;                  // Number of inline-cache slots, one per field access.
+		msize_t    num_icache_map = 0;                  // Number of inline-cache slot indices, either zero or bytecode length.
+		msize_t    num_profile    = 0;                  // Number of type-profile slots, either zero or bytecode length.
+		msize_t    src_line       = 0;                  // Line of definition.
+		uint32_t   hotness        = 0;                  // Calls and back-edges taken by the interpreter, used for tiering.
+		uint32_t   num_deopt      = 0;                  // Number of times the JIT code bailed out to the interpreter.
+		string*    src_chunk      = nullptr;            // Source of definition (chunk:function_name or chunk).
+		jfunction* jfunc          = nullptr;            // JIT function if there is one.
+		jfunction* osr_jfunc      = nullptr;            // JIT entry continuing from a loop header, for on-stack replacement.
+		bc::pos    osr_pc         = 0;                  // Loop header osr_jfunc was compiled for.
 		bc::insn   opcode_array[];
 		// any constant_array[];
 		// line_table[] line_array[];
+		// table_entry* icache_array[]; (Aligned)
+		// msize_t icache_map[];
+		// uint16_t profile_array[];
 
 		// Range observers.
 		//
 		std::span<bc::insn>  opcodes() { return {opcode_array, length}; }
 		std::span<any>       kvals() { return {(any*) &opcode_array[length], num_kval}; }
 		std::span<line_info> lines() { return {(line_info*) (num_kval + (any*) &opcode_array[length]), num_lines}; }
+		std::span<table_entry*> icache() {
+			uintptr_t p = uintptr_t(&lines().data()[num_lines]);
+			p           = (p + alignof(table_entry*) - 1) & ~uintptr_t(alignof(table_entry*) - 1);
+			return {(table_entry**) p, num_icache};
+		}
+		std::span<msize_t>      icache_map() { return {(msize_t*) &icache().data()[num_icache], num_icache_map}; }
+		std::span<uint16_t>     type_profile() { return {(uint16_t*) &icache_map().data()[num_icache_map], num_profile}; }
+
+		// Returns the inline-cache slot of the field access at the given position.
+		//
+		table_entry*& icache_at(bc::pos pos) { return icache()[icache_map()[pos]]; }
 
 		// Converts BC -> Line.
 		//
@@ -86,6 +109,15 @@ namespace li {
 		}
 	};
 
+	// Type-profile masks, the interpreter records the types of the values it observes at arithmetic,
+	// comparisons, field access receivers and call targets for the JIT.
+	//
+	inline constexpr uint16_t type_bit(value_type t) { return uint16_t(1u << t); }
+
+	// Set on the profile of a loop back-edge once on-stack replacement failed for it, back-edges record no types.
+	//
+	inline constexpr uint16_t profile_no_osr = type_bit(type_invalid);
+
 	// Native function details.
 	// - Not GC allocated.
 	//
@@ -14,6 +14,8 @@ namespace li {
 	//
 	struct array;
 	struct table;
+	struct omap;
+	struct tarray;
 	struct function;
 	struct jfunction;
 	struct function_proto;
@@ -29,6 +31,8 @@ namespace li::gc {
 	using stage_context = bool;
 	void traverse(stage_context s, array* o);
 	void traverse(stage_context s, table* o);
+	void traverse(stage_context s, omap* o);
+	void traverse(stage_context s, tarray* o);
 	void traverse(stage_context s, function* o);
 	void traverse(stage_context s, function_proto* o);
 	void traverse(stage_context s, object* o);
@@ -97,6 +101,7 @@ namespace li::gc {
 		// Internals.
 		//
 		void gc_init(page* p, vm* L, msize_t qlen, value_type t);
+		// - If weak is set, only checks whether the object is alive without marking it.
 		bool gc_tick(stage_context s, bool weak = false);
 	};
 	static_assert(sizeof(header) == 16, "Invalid GC header size.");
@@ -218,6 +223,10 @@ namespace li::gc {
 		msize_t collect_counter = 0;
 		bool    suspend         = false;
 
+		// Tables with weak keys or values, linked through table::weak_next.
+		//
+		table* weak_tables = nullptr;
+
 		// Free lists.
 		//
 		std::array<header*, num_size_classes> free_lists   = {nullptr};
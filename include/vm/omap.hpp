@@ -0,0 +1,61 @@
+#pragma once
+#include <vm/state.hpp>
+
+namespace li {
+	// Ordered map nodes, a B+ tree keeping every entry in the leaves. Inner nodes hold a lower bound
+	// of the keys and the entry count of each child so that descending by key or by rank never has
+	// to look at the children themselves.
+	//
+	static constexpr msize_t omap_order = 32;
+	struct omap_leaf : gc::leaf<omap_leaf> {
+		msize_t count = 0;
+		any     keys[omap_order];
+		any     values[omap_order];
+	};
+	struct omap_inner : gc::leaf<omap_inner> {
+		msize_t     count = 0;
+		any         keys[omap_order];            // Lower bound of the keys under each child.
+		msize_t     sizes[omap_order]    = {};  // Number of entries under each child.
+		gc::header* children[omap_order] = {};  // Leaves if the node is at height one.
+	};
+
+	struct omap : gc::node<omap, type_omap> {
+		static omap* create(vm* L);
+
+		gc::header* root   = nullptr;  // Leaf if height is zero.
+		msize_t     height = 0;
+		msize_t     length = 0;
+		omap*       parent = nullptr;  // Map a range view refers to, views cannot be modified.
+		any         lo     = nil;      // Bounds of the view as [lo, hi), nil if unbounded.
+		any         hi     = nil;
+
+		// Total order of the keys, numbers and strings by value, everything else by type and identity.
+		//
+		static bool less(any_t a, any_t b);
+
+		// Duplicates the map, views are duplicated into a map of the entries in range.
+		//
+		omap* duplicate(vm* L);
+
+		// Creates a view of the entries in [lo, hi) that stays valid as the map changes.
+		//
+		omap* range(vm* L, any_t lo, any_t hi);
+
+		// Map get/set, set removes the key if value is nil and returns false if the map is a view.
+		//
+		bool  set(vm* L, any_t key, any_t value);
+		any_t get(any_t key);
+
+		// Returns the rank of the first key not less than the given one, relative to the view if any.
+		//
+		msize_t lower_bound(any_t key);
+
+		// Gets the entry at the given rank, returns false if out of range.
+		//
+		bool at(msize_t rank, any& key, any& value);
+
+		// Number of entries in the map or view.
+		//
+		msize_t size();
+	};
+};
@@ -28,6 +28,11 @@ namespace li {
 	//
 	any_t LI_CC vm_invoke(vm* L, any* args, slot_t n_args);
 
+	// Resumes a frame of JIT code in the interpreter at the given bytecode position, the locals must
+	// already be written back to the stack.
+	//
+	any_t LI_CC vm_deopt(vm* L, any* args, slot_t n_args, msize_t pc);
+
 	// Panic function, should not return.
 	//
 	using fn_panic = void (*)(vm* L, const char* msg);
@@ -45,15 +50,17 @@ namespace li {
 
 	// Call frame as a linked list of caller records.
 	//
-	static constexpr msize_t  MAX_ARGS     = 32;
-	static constexpr slot_t   FRAME_SELF   = -3;  // specials relative to local 0
-	static constexpr slot_t   FRAME_TARGET = -2;
-	static constexpr slot_t   FRAME_CALLER = -1;
-	static constexpr slot_t   FRAME_SIZE   = 3;
-	static constexpr uint64_t FRAME_C_FLAG = (1ll << 17);
-	static constexpr slot_t   STACK_LENGTH = LI_STACK_SIZE / sizeof(any);
-	static constexpr slot_t   BC_MAX_IP    = FRAME_C_FLAG - 1;
+	static constexpr msize_t  MAX_ARGS        = 32;
+	static constexpr slot_t   FRAME_SELF      = -3;  // specials relative to local 0
+	static constexpr slot_t   FRAME_TARGET    = -2;
+	static constexpr slot_t   FRAME_CALLER    = -1;
+	static constexpr slot_t   FRAME_SIZE      = 3;
+	static constexpr uint64_t FRAME_C_FLAG    = (1ll << 17);
+	static constexpr uint32_t FRAME_POS_SHIFT = 18;  // Bit position of call_frame::stack_pos.
+	static constexpr slot_t   STACK_LENGTH    = LI_STACK_SIZE / sizeof(any);
+	static constexpr slot_t   BC_MAX_IP       = FRAME_C_FLAG - 1;
 	static_assert(STACK_LENGTH <= util::fill_bits(23), "Stack configured too large.");
+	static_assert(MAX_ARGS <= util::fill_bits(6), "Too many arguments for the call frame.");
 
 	struct call_frame {
 		// [locals of caller]
@@ -65,9 +72,10 @@ namespace li {
 		// [call_frame for previous function as any [will be number typed]]
 		// [locals of this func]
 		//
-		uint64_t caller_pc : 23 = 0;  // Instruction pointer after the call.
-		uint64_t stack_pos : 23 = 0;  // Stack position of frame (@local0).
-		uint64_t rsvd : 18      = 0;
+		uint64_t caller_pc : FRAME_POS_SHIFT = 0;  // Instruction pointer after the call.
+		uint64_t stack_pos : 23              = 0;  // Stack position of frame (@local0).
+		uint64_t caller_eh : 17              = 0;  // Exception handler the caller had armed, zero if none.
+		uint64_t caller_nargs : 6            = 0;  // Number of arguments the caller was invoked with, used to restore it on return.
 
 		inline constexpr bool multiplexed_by_c() const { return caller_pc & FRAME_C_FLAG; }
 	};
@@ -95,6 +103,7 @@ namespace li {
 		fn_panic           panic_fn        = &default_panic;            // Panic function.
 		uint32_t           jit_all : 1     = false;                     // JITs every parsed function.
 		uint32_t           jit_verbose : 1 = false;                     // JIT compilation prints debug information.
+		uint32_t           jit_threshold   = 0;                         // Hotness at which functions are promoted to the JIT, zero disables tiering.
 
 		// Stack.
 		//
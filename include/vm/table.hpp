@@ -4,44 +4,121 @@
 #include <vm/state.hpp>
 
 namespace li {
-	static constexpr msize_t overflow_factor    = 3;
-
 	struct table_entry {
 		any key;
 		any value;
 	};
-	static constexpr msize_t table_hash_shift = 4;
-	static_assert(sizeof(table_entry) == (1 << table_hash_shift), "Invalid constants.");
+
+	// Hash part control bytes, one per slot, full slots hold the low 7 bits of the key hash.
+	//
+	static constexpr msize_t group_width   = 16;
+	static constexpr int8_t  ctrl_empty    = -128;
+	static constexpr int8_t  ctrl_deleted  = -2;
+	static constexpr int8_t  ctrl_sentinel = -1;
 
 	struct table_nodes : gc::leaf<table_nodes> {
 		table_entry entries[];
+		// int8_t   ctrl[max(capacity, group_width)];
+	};
+	struct table_array : gc::leaf<table_array> {
+		any entries[];
+	};
+
+	// Global slots of a scope table, GGET/GSET address them by the index the parser assigned to the name
+	// while the table itself stays a view of them for $E, imports and the REPL. Every table write of a
+	// slotted key updates the slot, the entry pointer lets GSET write through to the table without hashing.
+	//
+	struct table_global {
+		any          key   = nil;
+		any          value = nil;
+		table_entry* entry = nullptr;  // Entry mirroring the value, may be stale and is validated before use.
 	};
+	struct table_globals : gc::leaf<table_globals> {
+		table*       index    = nullptr;  // Name to slot index.
+		msize_t      count    = 0;
+		msize_t      capacity = 0;
+		table_global entries[];
+	};
+	static constexpr msize_t min_table_size = 4;
+	static constexpr msize_t min_array_size = 4;
+
+	// Hash parts at least this large are rehashed incrementally, moving this many slots per insertion.
+	//
+	static constexpr msize_t incremental_rehash_min  = 1024;
+	static constexpr msize_t incremental_rehash_step = 2 * group_width;
 	struct table : gc::node<table, type_table> {
 		static table* create(vm* L, msize_t reserved_entry_count = 0);
 
-		size_t                  mask          = 0;
-		table_nodes*            node_list     = nullptr;
-		msize_t                 active_count  = 0;
-		uint8_t                 is_frozen : 1 = 0;
-		uint8_t                 rsvd : 7      = 0;
+		table_nodes*            node_list        = nullptr;
+		msize_t                 capacity         = 0;
+		msize_t                 growth_left      = 0;
+		msize_t                 active_count     = 0;
+		uint8_t                 is_frozen : 1    = 0;
+		uint8_t                 needs_shrink : 1 = 0;
+		uint8_t                 weak_keys : 1    = 0;
+		uint8_t                 weak_values : 1  = 0;
+		uint8_t                 is_perfect : 1   = 0;  // Every key is in its home group with a unique control byte.
+		uint8_t                 rsvd : 3         = 0;
+		table_array*            array_list       = nullptr;
+		msize_t                 array_size       = 0;
+		table_nodes*            old_list         = nullptr;  // Hash part being migrated out of, if any.
+		msize_t                 old_capacity     = 0;
+		msize_t                 migrate_pos      = 0;
+		table*                  weak_next        = nullptr;  // Next table in the GC's weak table list.
+		table_globals*          globals          = nullptr;  // Global slots if used as a scope table.
 
-		constexpr static size_t compute_mask(msize_t n) { return size_t(n - 1) << table_hash_shift; }
+		// Number of entries a hash part of the given capacity may hold before it has to be rehashed,
+		// capacity for a given number of entries.
+		//
+		static constexpr msize_t max_load(msize_t n) { return n < group_width ? n - 1 : n - n / 8; }
+		static constexpr msize_t capacity_for(msize_t n) {
+			msize_t c = min_table_size;
+			while (max_load(c) < n)
+				c <<= 1;
+			return c;
+		}
 
 		table_entry* begin() { return &node_list->entries[0]; }
-		table_entry* end() { return begin() + realsize(); }
-		msize_t      size() const { return msize_t((mask >> table_hash_shift) + 1); }
-		msize_t      realsize() const { return size() + overflow_factor; }
+		table_entry* end() { return begin() + size(); }
+		msize_t      size() const { return capacity; }
+		int8_t*      ctrl() { return (int8_t*) end(); }
+
+		// Array part holding the integer keys [0, array_size), begin/end only cover the hash part.
+		//
+		std::span<any> array_part() { return {array_list ? array_list->entries : nullptr, array_size}; }
+
+		// Previous hash part during an incremental rehash, slots below migrate_pos are already moved.
+		//
+		std::span<table_entry> old_part() { return {old_list ? old_list->entries : nullptr, old_list ? old_capacity : 0}; }
 
-		std::span<table_entry> find(size_t hash) {
-			auto it = begin() + ((hash & mask) >> table_hash_shift);
-			return {it, it + overflow_factor};
+		// Returns the array part slot for the key or nullptr if it belongs to the hash part.
+		//
+		any* find_array(any_t key) {
+			if (key.is_num()) {
+				number n = key.as_num();
+				if (0 <= n && n < array_size && msize_t(n) == n)
+					return &array_list->entries[msize_t(n)];
+			}
+			return nullptr;
 		}
 
+		// Checks whether a (possibly stale) entry pointer points into the current node list, since node
+		// lists are chunk aligned any such pointer is also aligned to an entry boundary.
+		//
+		bool owns(const table_entry* e) { return begin() <= e && e < end(); }
+
 		// Duplicates the table.
 		//
 		table* duplicate(vm* L) const {
 			table* tbl     = L->duplicate(this);
 			tbl->node_list = L->duplicate(tbl->node_list);
+			if (tbl->array_list)
+				tbl->array_list = L->duplicate(tbl->array_list);
+			if (tbl->old_list)
+				tbl->old_list = L->duplicate(tbl->old_list);
+			if (tbl->weak_keys || tbl->weak_values)
+				tbl->weak_next = std::exchange(L->gc.weak_tables, tbl);
+			tbl->globals = nullptr;
 			return tbl;
 		}
 
@@ -49,13 +126,69 @@ namespace li {
 		//
 		void join(vm* L, table* other);
 
-		// Rehashing resize.
+		// Rehashing resize to fit n entries, migrates dense integer keys to the array part.
 		//
 		void resize(vm* L, msize_t n);
 
-		// Table get/set.
+		// Rebuilds the hash part with the given capacity, dropping the deleted slots. If incremental is set
+		// large hash parts are moved over the next insertions instead.
+		//
+		void rehash(vm* L, msize_t new_capacity, bool incremental = false);
+
+		// Moves the next n slots of an incremental rehash, or all of them.
+		//
+		void migrate(vm* L, msize_t n = UINT32_MAX);
+
+		// Grows the array part to n slots, migrating the keys now in range from the hash part.
+		//
+		void resize_array(vm* L, msize_t n);
+
+		// Shrinks both parts to fit the current entries.
+		//
+		void compact(vm* L);
+
+		// Marks the table frozen and rebuilds the hash part so that every lookup is resolved by a single
+		// group match, falls back to a compacted layout if no small enough capacity allows it.
+		//
+		void freeze(vm* L);
+
+		// Returns the largest power of two n such that more than half of the keys [0, n) are in use.
+		//
+		msize_t optimal_array_size();
+
+		// Table get/set, set returns the hash entry written to or nullptr if the key was removed, stored
+		// in the array part or the table has global slots. set_entry skips updating the global slots.
+		//
+		table_entry* set(vm* L, any_t key, any_t value);
+		table_entry* set_entry(vm* L, any_t key, any_t value);
+		any_t        get(vm* L, any_t key);
+
+		// Returns the hash entry holding the key or nullptr if there is none.
+		//
+		table_entry* find_entry(any_t key);
+
+		// Returns the index of the first full slot at or after i in a node list or its size if there is none,
+		// the control bytes double as the occupancy bitmap.
+		//
+		static msize_t next_slot(std::span<table_entry> part, msize_t i);
+
+		// Clears all entries.
+		//
+		void clear();
+
+		// Returns the global slot of the name, assigning a new one holding its current value if it has none.
+		//
+		msize_t add_global(vm* L, string* name);
+
+		// Makes the keys and/or values weak, strings and non-GC values are never considered weak. Weak keys
+		// with strong values behave as ephemerons, the value is only kept alive by a live key.
+		//
+		void set_weak(vm* L, bool keys, bool values);
+
+		// GC helpers for weak tables, marks the values of the live keys in an ephemeron table returning
+		// whether anything new was marked, and removes the entries referencing dead objects.
 		//
-		void  set(vm* L, any_t key, any_t value);
-		any_t get(vm* L, any_t key);
+		bool mark_ephemerons(gc::stage_context s);
+		void sweep_weak(gc::stage_context s);
 	};
 };
\ No newline at end of file
@@ -0,0 +1,97 @@
+#pragma once
+#include <cfloat>
+#include <cmath>
+#include <vm/array.hpp>
+
+namespace li {
+	// Array of unboxed numbers or a slice of another array.
+	// - Typed arrays store elements as the given data type and their storage is never traversed.
+	// - Slices borrow the elements of their parent until they are first written to, elem is any for array parents.
+	//
+	struct tarray : gc::node<tarray, type_tarray> {
+		static tarray* create(vm* L, li::type elem, msize_t length = 0, msize_t rsvd = 0);
+
+		// Creates a slice of the elements in [begin, end) of an array or typed array, returns nullptr if invalid.
+		//
+		static tarray* slice(vm* L, any_t src, msize_t begin, msize_t end);
+
+		// Parses an element type name ("f64", "f32", "i64", "i32", "i16" or "i8"), returns false if invalid.
+		//
+		static bool parse_type(any_t name, li::type& out);
+
+		array_store* storage = nullptr;
+		msize_t      length  = 0;
+		li::type     elem    = type::f64;
+		gc::header*  parent  = nullptr;  // Array the elements are borrowed from, nullptr if owned.
+		msize_t      offset  = 0;        // Index of the first element in the parent, offset by the origin of array parents.
+
+		uint8_t* data();
+		msize_t  stride() const { return size_of_data(elem); }
+		msize_t  size() const { return length; }
+		msize_t  capacity() const { return storage ? msize_t(storage->object_bytes() / stride()) : 0; }
+
+		// Number of elements that are accessible, slices may outlive the end of their parent. This is the length
+		// visible to scripts.
+		//
+		msize_t available() const;
+
+		// Returns true if the value can be stored in the array, numbers are truncated towards zero when stored as
+		// integers so the truncated value has to be representable, which also rejects NaN.
+		//
+		bool accepts(any_t value) const {
+			if (elem == type::any)
+				return true;
+			if (!value.is_num())
+				return false;
+			double x = value.as_num();
+			switch (elem) {
+				case type::i8:
+					return x > -129.0 && x < 128.0;
+				case type::i16:
+					return x > -32769.0 && x < 32768.0;
+				case type::i32:
+					return x > -2147483649.0 && x < 2147483648.0;
+				case type::i64:
+					return x >= -0x1p63 && x < 0x1p63;
+				case type::f32:
+					return !(x > FLT_MAX || x < -FLT_MAX) || std::isinf(x);
+				default:
+					return true;
+			}
+		}
+
+		// Copies borrowed elements into storage owned by the array, elements past the end of the parent are dropped.
+		//
+		void own(vm* L);
+
+		// Duplicates the array, slices are duplicated into an array owning the elements.
+		//
+		tarray* duplicate(vm* L);
+
+		// Reserve and resize.
+		//
+		void reserve(vm* L, msize_t n);
+		void resize(vm* L, msize_t n);
+
+		// Push-back.
+		//
+		void push(vm* L, any value);
+
+		// Pop-back.
+		//
+		any pop(vm* L);
+
+		// Inserts the values before the given index, removes n elements starting at the given index.
+		// - Both return false if the index is out of boundaries, remove clamps the count.
+		// - Values must be accepted by the array, neither keeps a head offset so front operations are linear.
+		//
+		bool insert(vm* L, msize_t idx, const any* values, msize_t n);
+		bool remove(vm* L, msize_t idx, msize_t n);
+
+		// Get/set.
+		// - Set returns false if it should throw because of out-of-boundaries index.
+		//
+		bool set(vm* L, msize_t idx, any value);
+		any  get(vm* L, msize_t idx);
+	};
+};
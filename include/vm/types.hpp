@@ -31,6 +31,8 @@ namespace li {
 	struct header;
 	struct array;
 	struct table;
+	struct omap;
+	struct tarray;
 	struct string;
 	struct function;
 	struct jfunction;
@@ -55,6 +57,8 @@ namespace li {
 		type_function   = 3,   // GC: Function.
 		type_string     = 4,   // GC: String.
 		type_class      = 5,   // GC: Class type.
+		type_omap       = 6,   // GC: Ordered map.
+		type_tarray     = 7,   // GC: Typed array.
 		type_bool       = 8,   // LI: Boolean | Literals.
 		type_nil        = 9,   // LI: Nil tag.
 		type_exception  = 10,  // LI: Exception tag. Not visible to user.
@@ -80,6 +84,8 @@ namespace li {
 		fn   = type_function,
 		str  = type_string,
 		vcl  = type_class,
+		omap = type_omap,
+		tarr = type_tarray,
 		i1   = type_bool,
 		nil  = type_nil,
 		exc  = type_exception,
@@ -110,7 +116,7 @@ namespace li {
 	static constexpr bool is_integer_data(type t) { return type::i8 <= t && t <= type::i64; }
 	static constexpr bool is_floating_point_data(type t) { return t == type::f32 || t == type::f64; }
 	static constexpr bool is_marker_data(type t) { return t == type::nil || t == type::exc; }
-	static constexpr bool is_gc_data(type t) { return t <= type::vcl; }
+	static constexpr bool is_gc_data(type t) { return t <= type::tarr; }
 	static constexpr msize_t size_of_data(type t) {
 		if (t == type::i8)
 			return 1;
@@ -157,6 +163,8 @@ namespace li {
 		result[type_string]     = "string";
 		result[type_object]     = "object";
 		result[type_class]      = "class";
+		result[type_omap]       = "omap";
+		result[type_tarray]     = "tarray";
 		result[type_nil]        = "nil";
 		result[type_bool]       = "bool";
 		result[type_exception]  = "exception";
@@ -233,6 +241,8 @@ namespace li {
 		LI_INLINE inline constexpr bool is_obj() const { return is<type_object>(); }
 		LI_INLINE inline constexpr bool is_vcl() const { return is<type_class>(); }
 		LI_INLINE inline constexpr bool is_fn() const { return is<type_function>(); }
+		LI_INLINE inline constexpr bool is_omap() const { return is<type_omap>(); }
+		LI_INLINE inline constexpr bool is_tarr() const { return is<type_tarray>(); }
 		LI_INLINE inline constexpr bool is_exc() const { return is<type_exception>(); }
 		LI_INLINE inline constexpr bool is_gc() const { return is_value_gc(value); }
 
@@ -252,6 +262,8 @@ namespace li {
 		LI_INLINE inline vclass*          as_vcl() const { return (vclass*) as_gc(); }
 		LI_INLINE inline object*          as_obj() const { return (object*) as_gc(); }
 		LI_INLINE inline function*        as_fn() const { return (function*) as_gc(); }
+		LI_INLINE inline omap*            as_omap() const { return (omap*) as_gc(); }
+		LI_INLINE inline tarray*          as_tarr() const { return (tarray*) as_gc(); }
 
 		// Bytewise equal comparsion.
 		//
@@ -332,6 +344,8 @@ namespace li {
 		LI_INLINE inline any(vclass* v) : any_t{mix_value(type_class, (uint64_t) v)} {}
 		LI_INLINE inline any(object* v) : any_t{mix_value(type_object, (uint64_t) v)} {}
 		LI_INLINE inline any(function* v) : any_t{mix_value(type_function, (uint64_t) v)} {}
+		LI_INLINE inline any(omap* v) : any_t{mix_value(type_omap, (uint64_t) v)} {}
+		LI_INLINE inline any(tarray* v) : any_t{mix_value(type_tarray, (uint64_t) v)} {}
 		LI_INLINE inline any(gc::header* v) : any_t{mix_value(gc::identify_value_type(v), (uint64_t) v)} {}
 
 		// Constructs default value of the data type.
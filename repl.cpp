@@ -83,6 +83,10 @@ int main(int argv, const char** args) {
 		} else if (!strcmp(args[i], "--jit-verbose")) {
 			L->jit_all = true;
 			L->jit_verbose = true;
+		} else if (!strcmp(args[i], "--jit-tiered")) {
+			L->jit_threshold = LI_JIT_THRESHOLD;
+		} else if (!strncmp(args[i], "--jit-tiered=", 13)) {
+			L->jit_threshold = std::max(atoi(args[i] + 13), 1);
 		} else if (!file_path) {
 			file_path = args[i];
 		}
@@ -7,7 +7,7 @@
 #include <vm/string.hpp>
 
 namespace li::ir {
-	static void lift_basic_block(builder bld, const std::vector<basic_block*>& bc_to_bb) {
+	static bool lift_basic_block(builder bld, const std::vector<basic_block*>& bc_to_bb, bc::reg reg_lo) {
 		// Local cache.
 		//
 		function_proto*         f = bld.blk->proc->f;
@@ -41,7 +41,41 @@ namespace li::ir {
 			}
 		};
 
+		// Records the interpreter state before an instruction the JIT may speculate on, if the speculation
+		// fails the frame is written back and the interpreter resumes at the given position.
+		//
+		bool is_entry     = bld.blk == bld.blk->proc->get_entry();
+		auto record_frame = [&](bc::pos at) {
+			auto fs = bld.emit<frame_state>(int32_t(at), int32_t(reg_lo));
+			for (bc::reg r = reg_lo; r != bc::reg(f->num_locals); r++) {
+				if (r >= 0 && is_entry && !local_locals[r + local_shift])
+					fs->operands.emplace_back(launder_value(bld.blk->proc, any(nil)));
+				else
+					fs->operands.emplace_back(get_reg(r));
+			}
+		};
+
+		// Type specialization only guards operands whose type is not known yet, the state is only recorded if
+		// the instruction has one:
+		// - Arithmetic and comparisons unless both sides are numbers.
+		// - Field accesses unless the receiver type is known.
+		// - Calls unless the target is a known non-constant function, constant ones may be natives with overloads.
+		//
+		auto record_arith = [&](bc::pos at, auto... regs) {
+			if (((get_reg(regs)->vt != type::f64) || ...))
+				record_frame(at);
+		};
+		auto record_field = [&](bc::pos at, bc::reg tbl) {
+			if (get_reg(tbl)->vt == type::any)
+				record_frame(at);
+		};
+		auto record_call = [&](bc::pos at, const ref<value>& target) {
+			if (target->vt != type::fn || target->is<constant>())
+				record_frame(at);
+		};
+
 		std::vector<use<>> call_args  = {};
+		bc::pos            call_begin = bc::no_pos;
 		bc::pos            ip        = bld.blk->bc_begin;
 		bc::pos            ip_end    = bld.blk->bc_end;
 		auto               opcodes    = f->opcodes();
@@ -67,6 +101,7 @@ namespace li::ir {
 				case bc::ADIV:
 				case bc::AMOD:
 				case bc::APOW: {
+					record_arith(bld.current_bc, b, c);
 					set_reg(a, bld.emit<binop>(op, get_reg(b), get_reg(c)));
 					continue;
 				}
@@ -109,6 +144,7 @@ namespace li::ir {
 				case bc::CLE:
 				case bc::CLT:
 				case bc::CEQ: {
+					record_arith(bld.current_bc, b, c);
 					set_reg(a, bld.emit<compare>(op, get_reg(b), get_reg(c)));
 					continue;
 				}
@@ -125,6 +161,12 @@ namespace li::ir {
 					set_reg(a, bld.emit<table_new>(b));
 					continue;
 				}
+				case bc::TDUP: {
+					bld.emit<gc_tick>();
+					auto r = bld.emit<ccall>(&lib::detail::builtin_dup.nfi, 2, get_kval(b));
+					set_reg(a, bld.emit<assume_cast>(r, type::tbl));
+					continue;
+				}
 				case bc::CCAT: {
 					auto to_str = [&](ref<value> i) {
 						if (i->vt != type::str) {
@@ -177,42 +219,106 @@ namespace li::ir {
 				// Tables:
 				//
 				case bc::TGET: {
+					record_field(bld.current_bc, c);
 					set_reg(a, bld.emit<field_get>(false, get_reg(c), get_reg(b)));
 					continue;
 				}
 				case bc::TGETR: {
+					record_field(bld.current_bc, c);
 					set_reg(a, bld.emit<field_get>(true, get_reg(c), get_reg(b)));
 					continue;
 				}
 				case bc::TSET: {
 					bld.emit<gc_tick>();
+					record_field(bld.current_bc, c);
 					bld.emit<field_set>(false, get_reg(c), get_reg(a), get_reg(b));
 					continue;
 				}
 				case bc::TSETR: {
 					bld.emit<gc_tick>();
+					record_field(bld.current_bc, c);
 					bld.emit<field_set>(true, get_reg(c), get_reg(a), get_reg(b));
 					continue;
 				}
+				// Globals are accessed through their scope table, which is kept coherent with the slots.
+				//
+				case bc::GGET: {
+					auto key = get_kval(c).as_tbl()->globals->entries[b].key;
+					set_reg(a, bld.emit<field_get>(true, get_kval(c), key));
+					continue;
+				}
+				case bc::GSET: {
+					auto key = get_kval(c).as_tbl()->globals->entries[a].key;
+					bld.emit<gc_tick>();
+					bld.emit<field_set>(true, get_kval(c), key, get_reg(b));
+					continue;
+				}
 
 				// Virtual calls:
 				//
 				case bc::PUSHI: {
+					if (call_args.empty())
+						call_begin = bld.current_bc;
 					call_args.emplace_back(launder_value(bld.blk->proc, any_t{insn.xmm()}));
 					continue;
 				}
 				case bc::PUSHR: {
+					if (call_args.empty())
+						call_begin = bld.current_bc;
 					call_args.emplace_back(get_reg(a));
 					continue;
 				}
+				case bc::TCALL: {
+					LI_ASSERT(call_args.size() == (b + 2));
+
+					// Self tail calls with enough arguments rebind the arguments and jump back to the start of the
+					// function, the loop this forms keeps the stack bounded like the interpreter does.
+					//
+					msize_t num_params = f->opcode_array[0].o == bc::VACHK ? f->opcode_array[0].a : 0;
+					ref<>   target     = call_args.back();
+					if (b >= num_params && (target->vt == type::fn || target->vt == type::any)) {
+						auto* self_blk = bld.blk->proc->add_block();
+						auto* call_blk = bld.blk->proc->add_block();
+						auto  is_self  = bld.emit<compare>(bc::CEQ, target, this_func());
+						spill();
+						bld.emit<jcc>(is_self, self_blk, call_blk);
+						bld.blk->proc->add_jump(bld.blk, self_blk);
+						bld.blk->proc->add_jump(bld.blk, call_blk);
+
+						builder sb{self_blk};
+						sb.current_bc = bld.current_bc;
+						for (msize_t i = 0; i != num_params; i++) {
+							sb.emit<store_local>(bc::reg(-(FRAME_SIZE + 1) - bc::reg(i)), ref<>(call_args[b - 1 - i]));
+						}
+						sb.emit<store_local>(bc::reg(FRAME_SELF), ref<>(call_args[b]));
+						sb.emit<jmp>(bc_to_bb[0]);
+						self_blk->proc->add_jump(self_blk, bc_to_bb[0]);
+
+						auto pos       = bld.current_bc;
+						bld            = builder{call_blk};
+						bld.current_bc = pos;
+					}
+
+					// Any other target is called and its result returned. Only mutual recursion grows the native
+					// stack this way, a real tail jump would need the backend to tear down the frame first.
+					//
+					record_call(call_begin, call_args.back());
+					bld.blk->proc->max_stack_slot = std::max<msize_t>(msize_t(call_args.size() + 1), bld.blk->proc->max_stack_slot);
+					auto vc                       = bld.emit<vcall>(std::move(*call_args.rbegin()), std::move(*std::next(call_args.rbegin())));
+					vc->operands.insert(vc->operands.end(), std::make_move_iterator(std::next(call_args.rbegin(), 2)), std::make_move_iterator(call_args.rend()));
+					call_args.clear();
+					bld.emit<ret>(std::move(vc));
+					return true;
+				}
 				case bc::CALL: {
 					LI_ASSERT(call_args.size() == (b + 2));
+					record_call(call_begin, call_args.back());
 					bld.blk->proc->max_stack_slot = std::max<msize_t>(msize_t(call_args.size() + 1), bld.blk->proc->max_stack_slot);
 					auto vc                       = bld.emit<vcall>(std::move(*call_args.rbegin()), std::move(*std::next(call_args.rbegin())));
 					vc->operands.insert(vc->operands.end(), std::make_move_iterator(std::next(call_args.rbegin(), 2)), std::make_move_iterator(call_args.rend()));
-					set_reg(a, std::move(vc));
 					call_args.clear();
 					// TODO: Br to rethrow based on result
+					set_reg(a, std::move(vc));
 					continue;
 				}
 				// TODO:
@@ -231,7 +337,7 @@ namespace li::ir {
 				//
 				case bc::RET: {
 					bld.emit<ret>(get_reg(a));
-					return;
+					return true;
 				}
 				case bc::JS:
 				case bc::JNS: {
@@ -246,14 +352,71 @@ namespace li::ir {
 					bld.emit<jcc>(cnd, tt, tf);
 					bld.blk->proc->add_jump(bld.blk, tt);
 					bld.blk->proc->add_jump(bld.blk, tf);
-					return;
+					return true;
+				}
+				case bc::JEQ:
+				case bc::JNE:
+				case bc::JLT:
+				case bc::JLE:
+				case bc::JNLT:
+				case bc::JNLE: {
+					auto tf = bc_to_bb[ip];
+					auto tt = bc_to_bb[ip + a];
+					if (op == bc::JNLT || op == bc::JNLE)
+						std::swap(tt, tf);
+					record_arith(bld.current_bc, b, c);
+					spill();
+
+					bc::opcode cmp;
+					switch (op) {
+						case bc::JEQ: cmp = bc::CEQ; break;
+						case bc::JNE: cmp = bc::CNE; break;
+						case bc::JLT:
+						case bc::JNLT: cmp = bc::CLT; break;
+						default: cmp = bc::CLE; break;
+					}
+					bld.emit<jcc>(bld.emit<compare>(cmp, get_reg(b), get_reg(c)), tt, tf);
+					bld.blk->proc->add_jump(bld.blk, tt);
+					bld.blk->proc->add_jump(bld.blk, tf);
+					return true;
+				}
+				case bc::FORPREP: {
+					auto tt = bc_to_bb[ip];
+					auto tf = bc_to_bb[ip + a];
+					record_arith(bld.current_bc, b, b + 1);
+					spill();
+					bld.emit<jcc>(bld.emit<compare>(c ? bc::CLE : bc::CLT, get_reg(b), get_reg(b + 1)), tt, tf);
+					bld.blk->proc->add_jump(bld.blk, tt);
+					bld.blk->proc->add_jump(bld.blk, tf);
+					return true;
+				}
+				case bc::FORLOOP: {
+					// FORPREP checked the induction variable, the bound and the step and the body cannot write to
+					// them, so they are numbers and the add and the exit test need no type checks.
+					//
+					auto tt  = bc_to_bb[ip + a];
+					auto tf  = bc_to_bb[ip];
+					auto num = [&](bc::reg r) -> ref<value> {
+						auto v = get_reg(r);
+						if (v->vt != type::f64)
+							v = bld.emit<assume_cast>(std::move(v), type::f64);
+						return v;
+					};
+					auto max = num(b + 1);
+					auto it  = bld.emit<binop>(bc::AADD, num(b), num(b + 2));
+					set_reg(b, it);
+					spill();
+					bld.emit<jcc>(bld.emit<compare>(c ? bc::CLE : bc::CLT, it, max), tt, tf);
+					bld.blk->proc->add_jump(bld.blk, tt);
+					bld.blk->proc->add_jump(bld.blk, tf);
+					return true;
 				}
 				case bc::JMP: {
 					auto tt = bc_to_bb[ip + a];
 					spill();
 					bld.emit<jmp>(tt);
 					bld.blk->proc->add_jump(bld.blk, tt);
-					return;
+					return true;
 				}
 				//case bc::ITER: {
 				//	auto tt = bc_to_bb[ip + a];
@@ -266,8 +429,7 @@ namespace li::ir {
 					continue;
 				}
 				default:
-					util::abort("Opcode %s NYI\n", bc::opcode_details(op).name);
-					return;
+					return false;
 			}
 		}
 
@@ -281,13 +443,31 @@ namespace li::ir {
 		spill();
 		bld.emit<jmp>(tt);
 		bld.blk->proc->add_jump(bld.blk, tt);
+		return true;
 	}
 
-	// Generates crude bytecode.
+	// Generates crude bytecode, returns null if the function uses an opcode the JIT does not support yet.
+	// If an OSR entry is given, the procedure instead starts at that bytecode position with all locals
+	// read from the frame of the interpreter.
 	//
-	std::unique_ptr<procedure> lift_bc(vm* L, function_proto* f) {
+	std::unique_ptr<procedure> lift_bc(vm* L, function_proto* f, bc::pos osr_entry) {
 		auto proc = std::make_unique<procedure>(L, f);
 
+		// Create the OSR entry point first so that it becomes the entry block. Functions with tail calls get an
+		// empty one at the start instead, so that self tail calls can jump back to the first bytecode block.
+		//
+		basic_block* osr      = nullptr;
+		basic_block* prologue = nullptr;
+		if (osr_entry != bc::no_pos) {
+			osr           = proc->add_block();
+			osr->bc_begin = osr_entry;
+			osr->bc_end   = osr_entry;
+		} else if (std::any_of(f->opcodes().begin(), f->opcodes().end(), [](const bc::insn& i) { return i.o == bc::TCALL; })) {
+			prologue           = proc->add_block();
+			prologue->bc_begin = 0;
+			prologue->bc_end   = 0;
+		}
+
 		// Bytecode label position to basic-block mapping.
 		//
 		std::vector<basic_block*> bc_to_bb = {};
@@ -303,11 +483,14 @@ namespace li::ir {
 			}
 		};
 		add_label(0);
+		if (osr) {
+			add_label(osr_entry);
+		}
 		for (bc::pos i = 0; i != f->length; i++) {
 			auto ip = i + 1;
 			if (f->opcode_array[i].o == bc::JMP) {
 				add_label(ip + f->opcode_array[i].a);
-			} else if (f->opcode_array[i].o == bc::JS || f->opcode_array[i].o == bc::JNS || f->opcode_array[i].o == bc::ITER) {
+			} else if (f->opcode_array[i].o == bc::JS || f->opcode_array[i].o == bc::JNS || (f->opcode_array[i].o >= bc::JEQ && f->opcode_array[i].o <= bc::ITER)) {
 				add_label(ip);
 				add_label(ip + f->opcode_array[i].a);
 			}
@@ -316,6 +499,8 @@ namespace li::ir {
 		// Determine all basic block ranges.
 		//
 		for (auto& block : proc->basic_blocks) {
+			if (block.get() == osr || block.get() == prologue)
+				continue;
 			bc::pos end = block->bc_begin + 1;
 			while (end < bc_to_bb.size() && !bc_to_bb[end]) {
 				end++;
@@ -323,13 +508,59 @@ namespace li::ir {
 			block->bc_end = end;
 		}
 
-		// Lift all blocks.
+		// Determine the lowest register the function refers to, frame states cover everything above it.
+		//
+		bc::reg reg_lo = 0;
+		for (auto& insn : f->opcodes()) {
+			auto& desc = bc::opcode_details(insn.o);
+			if (desc.a == bc::op_t::reg)
+				reg_lo = std::min(reg_lo, insn.a);
+			if (desc.b == bc::op_t::reg)
+				reg_lo = std::min(reg_lo, insn.b);
+			if (desc.c == bc::op_t::reg)
+				reg_lo = std::min(reg_lo, insn.c);
+		}
+
+		// Lift all blocks, tail calls may add new ones which are complete already.
+		//
+		for (size_t n = 0, num_blocks = proc->basic_blocks.size(); n != num_blocks; n++) {
+			auto* block = proc->basic_blocks[n].get();
+			if (block == osr || block == prologue)
+				continue;
+			if (!lift_basic_block(block, bc_to_bb, reg_lo))
+				return nullptr;
+		}
+
+		// Load every local from the interpreter's frame and jump to the loop header.
+		//
+		if (osr) {
+			builder bld{osr};
+			bld.current_bc = osr_entry;
+			for (bc::reg r = 0; r != f->num_locals; r++) {
+				bld.emit<store_local>(r, bld.emit<load_local>(r));
+			}
+			bld.emit<jmp>(bc_to_bb[osr_entry]);
+			proc->add_jump(osr, bc_to_bb[osr_entry]);
+		}
+		if (prologue) {
+			builder bld{prologue};
+			bld.current_bc = 0;
+			bld.emit<jmp>(bc_to_bb[0]);
+			proc->add_jump(prologue, bc_to_bb[0]);
+		}
+
+		// Delete the blocks unreachable from the entry point.
 		//
+		proc->dfs([](basic_block*) { return false; });
+		auto mark = proc->next_visited_mark;
 		for (auto& block : proc->basic_blocks) {
-			lift_basic_block(block.get(), bc_to_bb);
+			if (block->visited != mark) {
+				while (!block->successors.empty())
+					proc->del_jump(block.get(), block->successors.back());
+			}
 		}
 		for (auto it = proc->basic_blocks.begin() + 1; it != proc->basic_blocks.end();) {
-			if (it->get()->predecessors.empty()) {
+			if (it->get()->visited != mark) {
 				it = proc->del_block(it->get());
 			} else {
 				++it;
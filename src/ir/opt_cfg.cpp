@@ -64,9 +64,9 @@ namespace li::ir::opt {
 					}
 				}
 
-				// Set cold hint if unreachable.
+				// Set cold hint if unreachable or leaving to the interpreter.
 				//
-				if (term->is<unreachable>()) {
+				if (term->is<unreachable>() || term->is<deopt>()) {
 					bb->cold_hint = 100;
 				}
 
@@ -3,6 +3,7 @@
 #include <ir/proc.hpp>
 #include <ir/value.hpp>
 #include <lang/operator.hpp>
+#include <vm/table.hpp>
 
 namespace li::ir::opt {
 	// Folds constants.
@@ -23,6 +24,16 @@ namespace li::ir::opt {
 						}
 					}
 				}
+				if (ins->is<field_get>() && ins->operands[1]->is<constant>() && ins->operands[2]->is<constant>()) {
+					// Frozen tables cannot change under the compiled code, resolve the field now so that library
+					// calls through it can be specialized.
+					//
+					any obj = ins->operands[1]->as<constant>()->to_any();
+					if (obj.is_tbl() && obj.as_tbl()->is_frozen) {
+						ins->replace_all_uses(proc->add_const(any(obj.as_tbl()->get(proc->L, ins->operands[2]->as<constant>()->to_any()))));
+						return true;
+					}
+				}
 				if (ins->is<compare>()) {
 					bool is_tag_cmp = false;
 					is_tag_cmp      = is_tag_cmp || (ins->operands[1]->vt == type::nil && ins->operands[2]->vt != type::any);
@@ -60,11 +60,15 @@ namespace li::ir::opt {
 		// Actually load the value if it does not exist.
 		//
 		if (b->predecessors.empty()) {
-			LI_ASSERT(r < 0);
 			auto v = read_variable_local(r, b);
 			if (!v) {
 				v = reread_variable_local(r, b);
 				if (!v) {
+					// Locals that are not assigned yet are only read by frame states, since the interpreter
+					// never reads them either, pass nil.
+					//
+					if (r >= 0)
+						return launder_value(b->proc, any(nil));
 					builder bd{b};
 					v = bd.emit_front<load_local>(r);
 				}
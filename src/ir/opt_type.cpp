@@ -124,6 +124,55 @@ namespace li::ir::opt {
 		return {std::move(tchecked), std::move(tunchecked)};
 	}
 
+	// Finds the interpreter state the bytecode lifter recorded before the given instruction, fails if
+	// there is a side effect in between since resuming from it would repeat the effect.
+	//
+	static insn* find_frame_state(insn* i) {
+		basic_block* bb = i->parent;
+		insn*        it = i->prev;
+		while (true) {
+			if (!it->parent) {
+				if (bb->predecessors.size() != 1)
+					return nullptr;
+				bb = bb->predecessors.front();
+				it = bb->back();
+				continue;
+			}
+			if (it->is<frame_state>())
+				return it;
+			if (it->sideffect && !it->is<gc_tick>())
+				return nullptr;
+			it = it->prev;
+		}
+	}
+
+	// Replaces the instruction and the rest of its block with a deoptimization to the interpreter, or a
+	// trap if there is no state to resume from.
+	//
+	static void emit_bailout(procedure* proc, insn* i) {
+		insn* t;
+		if (auto* fs = find_frame_state(i)) {
+			t = builder{i}.emit_before<deopt>(i, fs->operands[0], fs->operands[1]);
+			t->operands.insert(t->operands.end(), fs->operands.begin() + 2, fs->operands.end());
+		} else {
+			t = builder{i}.emit_before<unreachable>(i);
+		}
+		while (t != t->parent->back())
+			t->parent->back()->erase();
+		while (!t->parent->successors.empty())
+			proc->del_jump(t->parent, t->parent->successors.back());
+	}
+
+	// Returns the types the interpreter observed at the bytecode position of the instruction, zero if unknown.
+	//
+	static uint16_t observed_types(insn* i) {
+		auto* f = i->parent->proc->f;
+		if (i->source_bc >= f->num_profile)
+			return 0;
+		return f->type_profile()[i->source_bc];
+	}
+	static bool was_observed(uint16_t profile, value_type t) { return !profile || (profile & type_bit(t)); }
+
 	// Each specialization.
 	//
 	static bool specialize_op(procedure* proc) {
@@ -146,6 +195,13 @@ namespace li::ir::opt {
 						if (i->operands[1]->vt == type::f64 || i->operands[2]->vt == type::f64)
 							return true;
 					}
+
+					// If both sides are unknown but only numbers were observed, speculate on them.
+					//
+					if (i->operands[1]->vt == type::any && i->operands[2]->vt == type::any) {
+						if (observed_types(i) == type_bit(type_number))
+							return true;
+					}
 				}
 
 				return false;
@@ -154,12 +210,15 @@ namespace li::ir::opt {
 				return false;
 			}
 
-			auto [y, f] = split_by(i.at, i->operands[1]->vt == type::any ? 1 : 2, type_number);
-			f           = builder{f}.emit_before<unreachable>(f);  // <-- TODO: trait block.
+			// If the operation never saw a number, the fast path is never taken.
+			//
+			if (!was_observed(observed_types(i.at), type_number)) {
+				emit_bailout(proc, i.at);
+				return true;
+			}
 
-			while (f != f->parent->back())
-				f->parent->back()->erase();
-			proc->del_jump(f->parent, f->parent->successors.back());
+			auto [y, f] = split_by(i.at, i->operands[1]->vt == type::any ? 1 : 2, type_number);
+			emit_bailout(proc, f);  // <-- TODO: trait block.
 
 			y->update();
 			y->for_each_user([](insn* i, size_t) {
@@ -184,12 +243,16 @@ namespace li::ir::opt {
 				return false;
 			}
 
+			// If the target was never a function, the call always leaves to the interpreter.
+			//
+			if (!was_observed(observed_types(i.at), type_function)) {
+				emit_bailout(proc, i.at);
+				return true;
+			}
+
 			auto [arr, e0] = split_by(i.at, 0, type_function);
 			// TODO: ^has trait -> e0
-			e0 = builder{e0}.emit_before<unreachable>(e0);  // <-- TODO: throw.
-			while (e0 != e0->parent->back())
-				e0->parent->back()->erase();
-			proc->del_jump(e0->parent, e0->parent->successors.back());
+			emit_bailout(proc, e0);
 			return true;
 		});
 	}
@@ -208,37 +271,26 @@ namespace li::ir::opt {
 				return false;
 			}
 
-			if (i->is<field_get>()) {
-				// Valid types: Table, Array, Userdata, String.
-				//
-				auto [tbl, e0] = split_by(i.at, 1, type_table);
-				auto [arr, e1] = split_by(e0, 1, type_array);
-				auto [udt, e2] = split_by(e1, 1, type_object); // invalid if raw
-				auto [str, e3] = split_by(e2, 1, type_string);
-
-				arr->operands[0] = launder_value(proc, true);
-				str->operands[0] = launder_value(proc, true);
-				// ^if key is not int, invalid.
-
-				e3 = builder{e3}.emit_before<unreachable>(e3);  // <-- TODO: throw.
-				while (e3 != e3->parent->back())
-					e3->parent->back()->erase();
-				proc->del_jump(e3->parent, e3->parent->successors.back());
-			} else {
-				// Valid types: Table, Array, Userdata.
-				//
-				auto [tbl, e0] = split_by(i.at, 1, type_table);
-				auto [arr, e1] = split_by(e0, 1, type_array);
-				auto [udt, e2] = split_by(e1, 1, type_object);  // invalid if raw
-
-				arr->operands[0] = launder_value(proc, true);
-				// ^if key is not int, invalid.
+			// Split by each valid receiver type the interpreter observed, or all of them if there is no profile.
+			//   Valid types: Table, Array, Typed array, Userdata, String (only for reads).
+			//
+			uint16_t profile = observed_types(i.at);
+			insn*    rest    = i.at;
+			for (value_type t : {type_table, type_array, type_tarray, type_object, type_string}) {
+				if (t == type_string && i->is<field_set>())
+					continue;
+				if (!was_observed(profile, t))
+					continue;
 
-				e2 = builder{e2}.emit_before<unreachable>(e2);  // <-- TODO: throw.
-				while (e2 != e2->parent->back())
-					e2->parent->back()->erase();
-				proc->del_jump(e2->parent, e2->parent->successors.back());
+				auto [checked, unchecked] = split_by(rest, 1, t);
+				if (t == type_array || t == type_tarray || t == type_string) {
+					checked->operands[0] = launder_value(proc, true);
+					// ^if key is not int, invalid.
+				}
+				// ^invalid if raw for objects.
+				rest = unchecked;
 			}
+			emit_bailout(proc, rest);
 			return true;
 		});
 	}
@@ -356,13 +408,10 @@ namespace li::ir::opt {
 				}
 			}
 
-			// Finally replace i with unreachable.
+			// Finally bail out if no overload matched.
 			//
 			if (i) {
-				i = builder{i}.emit_before<unreachable>(i);  // <-- TODO: throw.
-				while (i != i->parent->back())
-					i->parent->back()->erase();
-				proc->del_jump(i->parent, i->parent->successors.back());
+				emit_bailout(proc, i);
 			}
 			return true;
 		});
@@ -381,6 +430,14 @@ namespace li::ir::opt {
 		while (specialize_field(proc))
 			proc->validate();
 		// TODO: remove y:f64 = assumecase f64:x, f64
+
+		// Frame states are only needed to build the deoptimization paths, drop them so that the values
+		// they refer to do not stay alive.
+		//
+		for (auto& bb : proc->basic_blocks) {
+			bb->erase_if([&](insn* ins) { return ins->is<frame_state>(); });
+		}
+		dce(proc);
 	}
 
 	// Infers constant type information and optimizes the control flow.
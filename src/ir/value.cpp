@@ -41,6 +41,10 @@ namespace li::ir {
 				return util::fmt(LI_BLU "vcl: %p" LI_DEF, gc);
 			case li::type::arr:
 				return util::fmt(LI_BLU "arr: %p" LI_DEF, gc);
+			case li::type::omap:
+				return util::fmt(LI_BLU "map: %p" LI_DEF, gc);
+			case li::type::tarr:
+				return util::fmt(LI_BLU "tar: %p" LI_DEF, gc);
 			case li::type::fn:
 				return util::fmt(LI_BLU "fn:  %p" LI_DEF, gc);
 			case li::type::nfni:
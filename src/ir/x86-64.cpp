@@ -4,6 +4,7 @@
 #include <vm/runtime.hpp>
 #include <vm/array.hpp>
 #include <vm/table.hpp>
+#include <vm/tarray.hpp>
 
 #if LI_VTUNE
 	#include <jitprofiling.h>
@@ -275,43 +276,134 @@ namespace li::ir {
 		local_store(b, idx, type_erased);
 	}
 
-	// Looks up a value from a table without using traits.
+	// Splits the block at the current position, the returned block takes over the successors.
 	//
-	static void table_lookup_raw(mblock& b, value* vkey, mreg tbl, mreg out) {
-		// Move the key with the typed erased to a temporary.
+	static mblock* split_block(mblock& b) {
+		auto* cont = b->add_block();
+		cont->hot  = b.hot;
+		for (auto* suc : b.successors) {
+			*range::find(suc->predecessors, &b) = cont;
+		}
+		cont->successors = std::move(b.successors);
+		b.successors.clear();
+		return cont;
+	}
+
+	// Adds a block for the slow path of the given block, placed after the hot code.
+	//
+	static mblock* add_cold_block(mblock& b) {
+		auto* blk = b->add_block();
+		blk->hot  = std::min(b.hot, 0) - 1;
+		return blk;
+	}
+
+	// Looks up a key in the home group of a table, only the first slot whose control byte matches is checked.
+	// Misses go to the runtime, which handles the other candidates, the rest of the probe sequence and
+	// tables being rehashed. Returns the block continuing after the lookup.
+	//
+	static mblock* table_lookup_raw(mblock& b, value* vtbl, value* vkey, mreg tbl, mreg out) {
+		static_assert(sizeof(table_entry) == 16, "table entry is assumed to be 16 bytes.");
+
+		// Move the key with the typed erased to a temporary and hash it.
 		//
 		auto key = b->next_gp();
 		if (vkey->vt == type::any)
 			b.append(vop::movi, key, REG(vkey));
 		else
 			type_erase(b, vkey, key);
+		auto hash = b->next_gp();
+		value_hash(b, key, hash, vkey);
 
-		// Hash the value and mask it, sum with table base.
+		// First slot of the home group, (hash >> 7) & ((capacity - 1) / group_width) groups in.
 		//
-		auto base = b->next_gp();
-		value_hash(b, key, base, vkey);
-		AND(b, base, mmem{.base = tbl, .disp = offsetof(table, mask)});
-		ADD(b, base, mmem{.base = tbl, .disp = offsetof(table, node_list)});
+		auto nodes = b->next_gp();
+		auto cap   = b->next_gp();
+		auto base  = b->next_gp();
+		auto h1    = b->next_gp();
+		b.append(vop::loadi64, nodes, mmem{.base = tbl, .disp = offsetof(table, node_list)});
+		b.append(vop::loadi32, cap, mmem{.base = tbl, .disp = offsetof(table, capacity)});
+		LEA(b, base, mmem{.base = cap, .disp = -1});
+		SHR(b, base, std::countr_zero(group_width));
+		b.append(vop::movi, h1, hash);
+		SHR(b, h1, 7);
+		AND(b, base, h1);
+		SHL(b, base, std::countr_zero(group_width));
+
+		// Match the control bytes of the group against h2, the control bytes follow the entries.
+		//
+		auto ctrl = b->next_gp();
+		auto h2   = b->next_gp();
+		auto tmp  = b->next_gp();
+		SHL(b, cap, 4);
+		LEA(b, ctrl, mmem{.base = nodes, .index = cap, .scale = 1, .disp = offsetof(table_nodes, entries)});
+		ADD(b, ctrl, base);
+		b.append(vop::movi, h2, hash);
+		AND(b, h2, 0x7F);
+		b.append(vop::movi, tmp, 0x0101010101010101ll);
+		IMUL(b, h2, tmp);
+
+		auto vctrl = b->next_fp();
+		auto vh2   = b->next_fp();
+		auto mask  = b->next_gp();
+		b.append(vop::movf, vh2, h2);
+		if constexpr (USE_AVX) {
+			VMOVDQU(b, vctrl, mmem{.base = ctrl});
+			VPUNPCKLQDQ(b, vh2, vh2, vh2);
+			VPCMPEQB(b, vctrl, vctrl, vh2);
+			VPMOVMSKB(b, mask, vctrl);
+		} else {
+			MOVDQU(b, vctrl, mmem{.base = ctrl});
+			PUNPCKLQDQ(b, vh2, vh2);
+			PCMPEQB(b, vctrl, vh2);
+			PMOVMSKB(b, mask, vctrl);
+		}
 
-		// Allocate a temporary to hold the result.
+		// Check the key of the first candidate. Without any it checks the first slot of the group, which
+		// cannot hold the key since its control byte would have matched.
 		//
-		auto tmp = b->next_gp();
-		b.append(vop::movi, tmp, nil);
-		for (size_t i = 0; i != overflow_factor; i++) {
-			mmem kv{.base = base, .disp = int32_t(offsetof(table_nodes, entries) + sizeof(table_entry) * i)};
-			CMP(b, FLAG_Z, key, kv);
-			kv.disp += sizeof(any);
-			CMOVZ(b, tmp, kv);
+		auto idx   = b->next_gp();
+		auto entry = b->next_gp();
+		auto hit   = b->next_gp();
+		OR(b, mask, 1 << group_width);
+		BSF(b, idx, mask);
+		AND(b, idx, group_width - 1);
+		ADD(b, idx, base);
+		SHL(b, idx, 4);
+		LEA(b, entry, mmem{.base = nodes, .index = idx, .scale = 1, .disp = offsetof(table_nodes, entries)});
+		CMP(b, FLAG_Z, key, mmem{.base = entry});
+		b.append(vop::setcc, hit, FLAG_Z);
+		b.append(vop::loadi64, out, mmem{.base = entry, .disp = offsetof(table_entry, value)});
+
+		// Split the block, misses call into the runtime from a cold block.
+		//
+		auto* cont = split_block(b);
+		auto* miss = add_cold_block(b);
+		b.append(vop::js, {}, hit, cont->uid, miss->uid);
+		b->add_jump(&b, cont);
+		b->add_jump(&b, miss);
+		{
+			mblock& b = *miss;
+			b.append(vop::movi, arch::map_gp_arg(0, 0), REF_VM());
+			type_erase(b, vtbl, arch::map_gp_arg(1, 0));
+			b.append(vop::movi, arch::map_gp_arg(2, 0), key);
+			b.append(vop::call, {}, (int64_t) &runtime::field_get_raw);
+			b.append(vop::movi, out, mreg(arch::from_native(arch::gp_retval)));
+			b.append(vop::jmp, {}, cont->uid);
+			b->add_jump(&b, cont);
 		}
-		b.append(vop::movi, out, tmp);
+		return cont;
 	}
 	static void array_lookup(mblock& b, value* vkey, mreg arr, mreg out) {
-		// Read table length and data pointer.
+		// Read table length and data pointer, offset by the head of the array.
 		//
-		auto tbl_len = b->next_gp();
+		auto tbl_len   = b->next_gp();
+		auto tbl_head  = b->next_gp();
+		auto tbl_base  = b->next_gp();
 		auto tbl_store = b->next_gp();
 		b.append(vop::loadi32, tbl_len, mmem{.base = arr, .disp = offsetof(array, length)});
-		b.append(vop::loadi64, tbl_store, mmem{.base = arr, .disp = offsetof(array, storage)});
+		b.append(vop::loadi32, tbl_head, mmem{.base = arr, .disp = offsetof(array, head)});
+		b.append(vop::loadi64, tbl_base, mmem{.base = arr, .disp = offsetof(array, storage)});
+		LEA(b, tbl_store, mmem{.base = tbl_base, .index = tbl_head, .scale = 8});
 
 		// Address both and emit a range check.
 		//
@@ -340,12 +432,16 @@ namespace li::ir {
 		b.append(vop::loadi64, out, mmem{.base = result_cc});
 	}
 	static void array_write(mblock& b, value* vkey, mreg arr, mreg in) {
-		// Read table length and data pointer.
+		// Read table length and data pointer, offset by the head of the array.
 		//
 		auto tbl_len   = b->next_gp();
+		auto tbl_head  = b->next_gp();
+		auto tbl_base  = b->next_gp();
 		auto tbl_store = b->next_gp();
 		b.append(vop::loadi32, tbl_len, mmem{.base = arr, .disp = offsetof(array, length)});
-		b.append(vop::loadi64, tbl_store, mmem{.base = arr, .disp = offsetof(array, storage)});
+		b.append(vop::loadi32, tbl_head, mmem{.base = arr, .disp = offsetof(array, head)});
+		b.append(vop::loadi64, tbl_base, mmem{.base = arr, .disp = offsetof(array, storage)});
+		LEA(b, tbl_store, mmem{.base = tbl_base, .index = tbl_head, .scale = 8});
 
 		// Address the destination and emit the initial comparison.
 		//
@@ -370,9 +466,185 @@ namespace li::ir {
 		b.append(vop::storei64, {}, adr, in);
 	}
 
+	// Typed arrays owning their elements are accessed in-line, slices, bad indices and values that have to be
+	// checked are left to the runtime.
+	//
+	static bool tarray_key(value* vkey) {
+		if (vkey->is<constant>())
+			return vkey->as<constant>()->to_any().is_num();
+		return vkey->vt == type::f64 || is_integer_data(vkey->vt);
+	}
+	static void tarray_index(mblock& b, value* vkey, mreg arr, mreg elem, mreg data, mreg idx, mreg ok) {
+		// Read the header and the storage of the array.
+		//
+		auto len    = b->next_gp();
+		auto parent = b->next_gp();
+		b.append(vop::loadi32, len, mmem{.base = arr, .disp = offsetof(tarray, length)});
+		b.append(vop::loadi64, parent, mmem{.base = arr, .disp = offsetof(tarray, parent)});
+		b.append(vop::loadi32, elem, mmem{.base = arr, .disp = offsetof(tarray, elem)});
+		b.append(vop::loadi64, data, mmem{.base = arr, .disp = offsetof(tarray, storage)});
+		if (vkey->is<constant>())
+			b.append(vop::movi, idx, (int64_t) msize_t(vkey->as<constant>()->to_any().as_num()));
+		else if (vkey->vt == type::f64)
+			b.append(vop::icvt, idx, REG(vkey));
+		else
+			b.append(vop::izx32, idx, REG(vkey));
+
+		// Range check and make sure the array owns its elements.
+		//
+		auto tmp = b->next_gp();
+		CMP(b, FLAG_NBE, len, idx);
+		b.append(vop::setcc, ok, FLAG_NBE);
+		CMP(b, FLAG_Z, parent, 0);
+		b.append(vop::setcc, tmp, FLAG_Z);
+		AND(b, ok, tmp);
+	}
+	static mmem tarray_element(mreg data, mreg idx, li::type ty) {
+		return mmem{.base = data, .index = idx, .scale = int8_t(size_of_data(ty)), .disp = offsetof(array_store, entries)};
+	}
+
+	// Splits the block and switches over the element type if the checks pass, the handler emits the access for each
+	// type into the given block and returns the block that continues, everything else goes to the miss block.
+	// Returns the block continuing after the access.
+	//
+	template<typename F>
+	static mblock* tarray_switch(mblock& b, mreg ok, mreg elem, mblock* miss, std::initializer_list<li::type> types, F&& handler) {
+		std::vector<std::pair<mblock*, mblock*>> cases;
+		for (li::type ty : types) {
+			auto* test = b->add_block();
+			test->hot  = b.hot;
+			auto* blk  = b->add_block();
+			blk->hot   = b.hot;
+			cases.emplace_back(test, &handler(*blk, ty));
+
+			auto tmp = b->next_gp();
+			CMP(*test, FLAG_Z, elem, int64_t(ty));
+			test->append(vop::setcc, tmp, FLAG_Z);
+			test->append(vop::js, {}, tmp, blk->uid, ~0ll);
+			b->add_jump(test, blk);
+		}
+		auto* cont = split_block(b);
+
+		// Chain the tests and the exits.
+		//
+		b.append(vop::js, {}, ok, cases.front().first->uid, miss->uid);
+		b->add_jump(&b, cases.front().first);
+		b->add_jump(&b, miss);
+		for (size_t n = 0; n != cases.size(); n++) {
+			auto [test, exit] = cases[n];
+			auto* next        = n + 1 != cases.size() ? cases[n + 1].first : miss;
+			test->instructions.back().arg[2] = mop(int64_t(next->uid));
+			b->add_jump(test, next);
+			exit->append(vop::jmp, {}, cont->uid);
+			b->add_jump(exit, cont);
+		}
+		return cont;
+	}
+	static mblock* tarray_lookup(mblock& b, value* varr, value* vkey, mreg arr, mreg out) {
+		auto elem = b->next_gp();
+		auto data = b->next_gp();
+		auto idx  = b->next_gp();
+		auto ok   = b->next_gp();
+		tarray_index(b, vkey, arr, elem, data, idx, ok);
+
+		auto* miss = add_cold_block(b);
+		auto* cont = tarray_switch(b, ok, elem, miss, {type::f64, type::any, type::f32, type::i64, type::i32, type::i16, type::i8}, [&](mblock& b, li::type ty) -> mblock& {
+			auto adr = tarray_element(data, idx, ty);
+			if (ty == type::f64 || ty == type::any) {
+				b.append(vop::loadi64, out, adr);
+			} else if (ty == type::f32) {
+				auto tmp = b->next_fp();
+				b.append(vop::loadf32, tmp, adr);
+				type_erase(b, tmp, out, ty);
+			} else {
+				static constexpr vop loads[] = {vop::loadi8, vop::loadi16, vop::loadi32, vop::loadi64};
+				auto tmp = b->next_gp();
+				b.append(loads[std::countr_zero(size_of_data(ty))], tmp, adr);
+				type_erase(b, tmp, out, ty);
+			}
+			return b;
+		});
+		{
+			mblock& b = *miss;
+			b.append(vop::movi, arch::map_gp_arg(0, 0), REF_VM());
+			type_erase(b, varr, arch::map_gp_arg(1, 0));
+			type_erase(b, vkey, arch::map_gp_arg(2, 0));
+			b.append(vop::call, {}, (int64_t) &runtime::field_get_raw);
+			b.append(vop::movi, out, mreg(arch::from_native(arch::gp_retval)));
+			b.append(vop::jmp, {}, cont->uid);
+			b->add_jump(&b, cont);
+		}
+		return cont;
+	}
+	static mblock* tarray_write(mblock& b, value* varr, value* vkey, value* vval, mreg arr) {
+		auto elem = b->next_gp();
+		auto data = b->next_gp();
+		auto idx  = b->next_gp();
+		auto ok   = b->next_gp();
+		auto val  = b->next_gp();
+		tarray_index(b, vkey, arr, elem, data, idx, ok);
+		type_erase(b, vval, val);
+
+		// Anything can be stored into arrays of any, numbers are stored as is into f64 arrays or truncated into
+		// integer arrays when representable. Rounding into f32 arrays has to reject finite values past its range,
+		// leave it to the runtime.
+		//
+		auto* miss = add_cold_block(b);
+		auto  types = vval->vt == type::f64 ? std::initializer_list<li::type>{type::f64, type::any, type::i64, type::i32, type::i16, type::i8}
+		                                    : std::initializer_list<li::type>{type::any};
+		auto* cont = tarray_switch(b, ok, elem, miss, types, [&](mblock& b, li::type ty) -> mblock& {
+			auto adr = tarray_element(data, idx, ty);
+			if (ty == type::f64 || ty == type::any) {
+				b.append(vop::storei64, {}, adr, val);
+				return b;
+			}
+
+			// Truncate and check that it converts back to the same integer, NaN and values out of the range
+			// of an i64 convert to its minimum which is left to the runtime as well.
+			//
+			auto fv   = b->next_fp();
+			auto iv   = b->next_gp();
+			auto tmp  = b->next_gp();
+			auto fits = b->next_gp();
+			b.append(vop::movf, fv, val);
+			b.append(vop::icvt, iv, fv);
+			if (ty == type::i64) {
+				b.append(vop::movi, tmp, INT64_MIN);
+				CMP(b, FLAG_NZ, iv, tmp);
+				b.append(vop::setcc, fits, FLAG_NZ);
+			} else {
+				static constexpr vop extends[] = {vop::isx8, vop::isx16, vop::isx32};
+				b.append(extends[std::countr_zero(size_of_data(ty))], tmp, iv);
+				CMP(b, FLAG_Z, iv, tmp);
+				b.append(vop::setcc, fits, FLAG_Z);
+			}
+			auto* store = b->add_block();
+			store->hot  = b.hot;
+			b.append(vop::js, {}, fits, store->uid, miss->uid);
+			b->add_jump(&b, store);
+			b->add_jump(&b, miss);
+
+			static constexpr vop stores[] = {vop::storei8, vop::storei16, vop::storei32, vop::storei64};
+			store->append(stores[std::countr_zero(size_of_data(ty))], {}, adr, iv);
+			return *store;
+		});
+		{
+			mblock& b = *miss;
+			b.append(vop::movi, arch::map_gp_arg(0, 0), REF_VM());
+			type_erase(b, varr, arch::map_gp_arg(1, 0));
+			type_erase(b, vkey, arch::map_gp_arg(2, 0));
+			b.append(vop::movi, arch::map_gp_arg(3, 0), val);
+			b.append(vop::call, {}, (int64_t) &runtime::field_set_raw);
+			b.append(vop::jmp, {}, cont->uid);
+			b->add_jump(&b, cont);
+		}
+		return cont;
+	}
+
 	// Main lifter switch.
 	//
-	static void mlift(mblock& b, insn* i) {
+	static void mlift(mblock*& cur, insn* i) {
+		mblock& b = *cur;
 		switch (i->opc) {
 			// Locals.
 			//
@@ -401,6 +673,13 @@ namespace li::ir {
 							array_write(b, i->operands[2], REGV(i->operands[1]), val);
 							return;
 						}
+						case type::tarr: {
+							if (tarray_key(i->operands[2])) {
+								cur = tarray_write(b, i->operands[1], i->operands[2], i->operands[3], REGV(i->operands[1]));
+								return;
+							}
+							break;
+						}
 						case type::tbl: {
 						}
 						case type::str: {
@@ -424,13 +703,25 @@ namespace li::ir {
 				{
 					switch (i->operands[1]->vt) {
 						case type::tbl: {
-							table_lookup_raw(b, i->operands[2], REGV(i->operands[1]), REG(i));
-							return;
+							// Integer keys may live in the array part, leave them to the runtime.
+							//
+							if (i->operands[2]->vt == type::str) {
+								cur = table_lookup_raw(b, i->operands[1], i->operands[2], REGV(i->operands[1]), REG(i));
+								return;
+							}
+							break;
 						}
 						case type::arr: {
 							array_lookup(b, i->operands[2], REGV(i->operands[1]), REG(i));
 							return;
 						}
+						case type::tarr: {
+							if (tarray_key(i->operands[2])) {
+								cur = tarray_lookup(b, i->operands[1], i->operands[2], REGV(i->operands[1]), REG(i));
+								return;
+							}
+							break;
+						}
 						case type::str: {
 
 						}
@@ -856,7 +1147,7 @@ namespace li::ir {
 				auto tmp = b->next_gp();
 				b.append(vop::movi, tmp, mop(-intptr_t(&b->source->L->stack[0])));
 				LEA(b, tmp, mmem{.base = vreg_args, .index = tmp, .scale = 1, .disp = 8 * (FRAME_SIZE + 1)});
-				SHL(b, tmp, 23 - 3);
+				SHL(b, tmp, FRAME_POS_SHIFT - 3);
 				OR(b, tmp, i->source_bc);
 				b.append(vop::storei64, {}, mmem{.base = vreg_tos, .disp = -8}, tmp);
 
@@ -910,6 +1201,24 @@ namespace li::ir {
 				b.append(vop::ret, {}, mop(r));
 				return;
 			}
+			case opcode::deopt: {
+				// Write the frame back for the interpreter.
+				//
+				int32_t reg_lo = i->operands[1]->as<constant>()->i32;
+				for (size_t n = 2; n != i->operands.size(); n++) {
+					local_store(b, mop(int64_t(reg_lo + int32_t(n - 2))), i->operands[n]);
+				}
+
+				// Resume at the bytecode and return its result.
+				//
+				b.append(vop::movi, arch::map_gp_arg(0, 0), REF_VM());
+				b.append(vop::movi, arch::map_gp_arg(1, 0), mreg(vreg_args));
+				b.append(vop::movi, arch::map_gp_arg(2, 0), mreg(vreg_nargs));
+				b.append(vop::movi, arch::map_gp_arg(3, 0), int64_t(i->operands[0]->as<constant>()->i32));
+				b.append(vop::call, {}, (int64_t) &vm_deopt);
+				b.append(vop::ret, {}, mop(mreg(arch::from_native(arch::gp_retval))));
+				return;
+			}
 			case opcode::unreachable: {
 				b.append(vop::unreachable, {});
 				return;
@@ -964,8 +1273,9 @@ namespace li::ir {
 			}
 		}
 
-		// For each block:
+		// For each block, lowering may split them so keep track of the final order.
 		//
+		std::vector<mblock*> layout, cold;
 		for (auto& b : m->source->basic_blocks) {
 			//printf("-- Block $%x", b->uid);
 			//if (b->cold_hint)
@@ -979,17 +1289,47 @@ namespace li::ir {
 			auto* mb = (mblock*) b->visited;
 			for (auto& suc : b->successors)
 				m->add_jump(mb, (mblock*) suc->visited);
+			layout.emplace_back(mb);
+			auto split = std::prev(m->basic_blocks.end());
+			auto hot   = mb->hot;
 
 			// Lift each instruction.
 			//
 			for (auto* i : b->insns()) {
 				//printf(LI_GRN "#%-5x" LI_DEF "\t\t %s\n", i->source_bc, i->to_string(true).c_str());
 				//size_t n = mb->instructions.size();
-				mlift(*mb, i);
+				mlift(mb, i);
 				// while (n != mb->instructions.size()) {
 				//	puts(mb->instructions[n++].to_string().c_str());
 				//}
 			}
+
+			// Blocks split out while lifting follow in order, the ones colder than the block are placed last.
+			//
+			for (auto it = std::next(split); it != m->basic_blocks.end(); ++it) {
+				if (it->hot < hot)
+					cold.emplace_back(&*it);
+				else
+					layout.emplace_back(&*it);
+			}
+		}
+
+		// Renumber the blocks in that order, the assembler lays them out by name.
+		//
+		layout.insert(layout.end(), cold.begin(), cold.end());
+		std::vector<int64_t> names(m->next_block);
+		for (size_t n = 0; n != layout.size(); n++)
+			names[layout[n]->uid] = int64_t(n);
+		for (auto* mb : layout) {
+			mb->uid = msize_t(names[mb->uid]);
+			for (auto& ins : mb->instructions) {
+				if (ins.is(vop::js)) {
+					ins.arg[1] = mop(names[ins.arg[1].i64]);
+					ins.arg[2] = mop(names[ins.arg[2].i64]);
+				} else if (ins.is(vop::jmp)) {
+					ins.arg[0] = mop(names[ins.arg[0].i64]);
+				}
+			}
 		}
 		return m;
 	}
@@ -50,6 +50,54 @@ namespace li {
 		reg_next = tmp;
 	}
 
+	// Conditional jump fusion.
+	//
+	std::optional<bc::pos> func_scope::fuse_jcc(const expression& cc, bool on_true, bc::rel target) {
+		// Condition must be the result of the last instruction which must not be a jump target.
+		//
+		if (cc.kind != expr::reg || fn.pc.empty() || fn.last_target == fn.pc.size())
+			return std::nullopt;
+		auto& insn = fn.pc.back();
+		if (insn.a != cc.reg)
+			return std::nullopt;
+
+		// Greater-than forms are emitted with the operands swapped, negation is kept explicit so that
+		// comparisons against NaN branch the same way.
+		//
+		bc::opcode op;
+		bool       swap = false;
+		switch (insn.o) {
+			case bc::CEQ:
+				op = on_true ? bc::JEQ : bc::JNE;
+				break;
+			case bc::CNE:
+				op = on_true ? bc::JNE : bc::JEQ;
+				break;
+			case bc::CLT:
+				op = on_true ? bc::JLT : bc::JNLT;
+				break;
+			case bc::CLE:
+				op = on_true ? bc::JLE : bc::JNLE;
+				break;
+			case bc::CGT:
+				op   = on_true ? bc::JLT : bc::JNLT;
+				swap = true;
+				break;
+			case bc::CGE:
+				op   = on_true ? bc::JLE : bc::JNLE;
+				swap = true;
+				break;
+			default:
+				return std::nullopt;
+		}
+		if (swap) {
+			insn = bc::insn{op, target, insn.c, insn.b};
+		} else {
+			insn = bc::insn{op, target, insn.b, insn.c};
+		}
+		return bc::pos(fn.pc.size() - 1);
+	}
+
 	// Writes a function state as a function.
 	//
 	static function* write_func(func_state& fn, msize_t line, std::optional<bc::reg> implicit_ret = std::nullopt) {
@@ -84,7 +132,7 @@ namespace li {
 
 		// If routine does not end with a return, add the implicit return.
 		//
-		if (fn.pc.empty() || fn.pc.back().o != bc::RET) {
+		if (fn.pc.empty() || (fn.pc.back().o != bc::RET && fn.pc.back().o != bc::TCALL)) {
 			if (!implicit_ret) {
 				fn.pc.emplace_back(bc::insn{bc::KIMM, 0}).xmm() = nil.value;
 				implicit_ret = 0;
@@ -626,16 +674,16 @@ namespace li {
 	// Parses a table literal.
 	//
 	static expression expr_table(func_scope& scope) {
-		// TODO: Duplicate template.
-
-		// Create a new table.
+		// Create a new table, switched to a duplicate of a template once a field is parsed.
 		//
 		expression result = scope.alloc_reg();
 		auto       allocp = scope.emit(bc::TNEW, result.reg);
 
-		// Until list is exhausted set fields.
+		// Until list is exhausted set fields, constant ones are written into the template and the rest
+		// are reserved in it and patched after the duplication.
 		//
-		msize_t nexpr = 0;
+		table*               tmpl = nullptr;
+		std::vector<string*> dynamic_keys;
 		if (!scope.lex().opt('}')) {
 			while (true) {
 				reg_sweeper _r{scope};
@@ -654,12 +702,28 @@ namespace li {
 				if (value.kind == expr::err) {
 					return {};
 				}
-				value = value.to_anyreg(scope);
 
-				auto tmp = scope.alloc_reg();
-				scope.set_reg(tmp, any(field.str_val));
-				scope.emit(bc::TSETR, tmp, value.reg, result.reg);
-				++nexpr;
+				if (!tmpl) {
+					tmpl                  = table::create(scope.fn.L);
+					scope.fn.pc[allocp].o = bc::TDUP;
+					scope.fn.pc[allocp].b = scope.add_const(any(tmpl)).first;
+				}
+
+				// If the key was assigned a runtime value before, constants have to be written after it.
+				//
+				bool is_dynamic = std::find(dynamic_keys.begin(), dynamic_keys.end(), field.str_val) != dynamic_keys.end();
+				if (value.kind == expr::imm && !is_dynamic) {
+					tmpl->set(scope.fn.L, any(field.str_val), value.imm);
+				} else {
+					if (!is_dynamic) {
+						tmpl->set(scope.fn.L, any(field.str_val), any(false));
+						dynamic_keys.emplace_back(field.str_val);
+					}
+					value    = value.to_anyreg(scope);
+					auto tmp = scope.alloc_reg();
+					scope.set_reg(tmp, any(field.str_val));
+					scope.emit(bc::TSETR, tmp, value.reg, result.reg);
+				}
 
 				if (scope.lex().opt('}'))
 					break;
@@ -670,7 +734,6 @@ namespace li {
 				}
 			}
 		}
-		scope.fn.pc[allocp].b = nexpr;
 		return result;
 	}
 
@@ -1271,7 +1334,16 @@ namespace li {
 				// value return:
 				//
 				else {
-					scope.emit(bc::RET, expr_parse(scope).to_anyreg(scope));
+					auto r = expr_parse(scope).to_anyreg(scope);
+
+					// If returning the result of a call outside of a try block, emit a tail call instead.
+					//
+					auto& pc = scope.fn.pc;
+					if (!scope.lbl_catchpad && !pc.empty() && pc.back().o == bc::CALL && pc.back().a == r && scope.fn.last_target != pc.size()) {
+						pc.back() = bc::insn{bc::TCALL, 0, pc.back().b};
+					} else {
+						scope.emit(bc::RET, r);
+					}
 				}
 				return expression(nil);
 			}
@@ -2099,7 +2171,16 @@ namespace li {
 		if (cc.kind == expr::err) {
 			return {};
 		}
-		cc = cc.to_nextreg(scope);
+
+		// Emit the placeholder JCC, if fused the condition register is free to hold the result.
+		//
+		bc::pos jcc_pos;
+		if (auto j = scope.fuse_jcc(cc, false)) {
+			jcc_pos = *j;
+		} else {
+			cc      = cc.to_nextreg(scope);
+			jcc_pos = scope.emit(bc::JNS, 0, cc.reg);
+		}
 
 		// Define block reader.
 		//
@@ -2115,10 +2196,6 @@ namespace li {
 			}
 		};
 
-		// Emit the placeholder JCC.
-		//
-		auto jcc_pos = scope.emit(bc::JNS, 0, cc.reg);
-
 		// Schedule the if block.
 		//
 		if (!block_or_exp()) {
@@ -2197,25 +2274,26 @@ namespace li {
 		auto pb = std::exchange(scope.lbl_break, scope.make_label());
 		auto pc = std::exchange(scope.lbl_continue, scope.make_label());
 
+		// Reserve next register for break-with-value, initialize to nil.
+		//
+		auto result = expression{nil}.to_nextreg(scope);
+
 		// Point the continue label at the beginning.
 		//
 		scope.set_label_here(scope.lbl_continue);
 
-		// Parse the condition, jump to break if not met.
+		// Parse the condition in its own scope, jump to break if not met.
 		//
-		auto cc = expr_parse(scope);
-		if (cc.kind == expr::err) {
-			return {};
+		{
+			func_scope cscope{scope.fn};
+			auto       cc = expr_parse(cscope);
+			if (cc.kind == expr::err) {
+				return {};
+			}
+			if (!cscope.fuse_jcc(cc, false, scope.lbl_break)) {
+				cscope.emit(bc::JNS, scope.lbl_break, cc.to_anyreg(cscope));
+			}
 		}
-		cc = cc.to_anyreg(scope);
-
-		// Reserve next register for break-with-value, initialize to nil.
-		//
-		auto result = expression{nil}.to_nextreg(scope);
-
-		// Emit the condition.
-		//
-		scope.emit(bc::JNS, scope.lbl_break, cc.reg);
 
 		// Parse the block.
 		//
@@ -2292,36 +2370,30 @@ namespace li {
 				}
 			}
 
-			// Allocate 5 consequtive registers:
-			// [it], [max], [step], [<cc>] [<result>]
+			// Allocate 4 consequtive registers:
+			// [it], [max], [step], [<result>]
 			//
-			auto iter_base = scope.alloc_reg(5);
+			auto iter_base = scope.alloc_reg(4);
 			i.to_reg(scope, iter_base);
-			i2.to_reg(scope, iter_base + 1);
+			if (i2.kind == expr::imm && i2.imm == nil) {
+				scope.set_reg(iter_base + 1, std::numeric_limits<number>::infinity());
+			} else {
+				i2.to_reg(scope, iter_base + 1);
+			}
 			scope.set_reg(iter_base + 2, step);
-			scope.set_reg(iter_base + 4, nil);
+			scope.set_reg(iter_base + 3, nil);
 
 			// Allocate new continue and break labels and the local.
 			//
 			auto pb = std::exchange(scope.lbl_break, scope.make_label());
 			auto pc = std::exchange(scope.lbl_continue, scope.make_label());
+			auto lbl_body = scope.make_label();
 			scope.locals.push_back({k, true, iter_base});
 
-			// Skip the AADD on first entry.
+			// Check the types and skip the loop if the range is empty.
 			//
-			scope.emit(bc::JMP, 1);
-
-			// Point the continue label at the beginning.
-			//
-			scope.set_label_here(scope.lbl_continue);
-
-			// Parse the condition, jump to break if we reached the end.
-			//
-			scope.emit(bc::AADD, iter_base, iter_base, iter_base + 2);  // it = it + step
-			if (i2.kind != expr::imm || i2.imm != nil) {
-				scope.emit(inclusive ? bc::CGT : bc::CGE, iter_base + 3, iter_base, iter_base + 1);  // cc = !cmp(it, max)
-				scope.emit(bc::JS, scope.lbl_break, iter_base + 3);
-			}
+			scope.emit(bc::FORPREP, scope.lbl_break, iter_base, inclusive);
+			scope.set_label_here(lbl_body);
 
 			// Parse the block.
 			//
@@ -2332,9 +2404,10 @@ namespace li {
 				return {};
 			}
 
-			// Jump to continue.
+			// Point the continue label at the step, loop back to the body if we did not reach the end.
 			//
-			scope.emit(bc::JMP, scope.lbl_continue);
+			scope.set_label_here(scope.lbl_continue);
+			scope.emit(bc::FORLOOP, lbl_body, iter_base, inclusive);
 
 			// Emit break label.
 			//
@@ -2345,7 +2418,7 @@ namespace li {
 			scope.lbl_break    = pb;
 			scope.lbl_continue = pc;
 			scope.locals.pop_back();
-			return expression(iter_base + 4);
+			return expression(iter_base + 3);
 		}
 		// If enumerating for:
 		//
@@ -0,0 +1,534 @@
+#include <cmath>
+#include <lib/std.hpp>
+#include <util/pdqsort.hpp>
+#include <util/user.hpp>
+#include <vector>
+#include <vm/array.hpp>
+#include <vm/omap.hpp>
+#include <vm/string.hpp>
+#include <vm/tarray.hpp>
+#if LI_HAS_AVX2
+	#include <immintrin.h>
+#elif LI_HAS_SSE2
+	#include <emmintrin.h>
+#endif
+
+namespace li::lib {
+	// Vector helpers, boxed lanes are detected by the high dword being at or above the first non-number tag.
+	//
+	static constexpr uint32_t boxed_limit = uint32_t(make_tag(type_number + 1) >> 32) & ~0x7fffu;
+#if LI_HAS_AVX2
+	namespace simd {
+		using vec                     = __m256d;
+		static constexpr size_t lanes = 4;
+		static vec    load(const double* p) { return _mm256_loadu_pd(p); }
+		static void   store(double* p, vec v) { _mm256_storeu_pd(p, v); }
+		static vec    splat(double x) { return _mm256_set1_pd(x); }
+		static vec    add(vec a, vec b) { return _mm256_add_pd(a, b); }
+		static vec    mul(vec a, vec b) { return _mm256_mul_pd(a, b); }
+		static vec    min(vec acc, vec x) { return _mm256_min_pd(x, acc); }
+		static vec    max(vec acc, vec x) { return _mm256_max_pd(x, acc); }
+		static double lane(vec v, size_t i) {
+			alignas(32) double r[lanes];
+			_mm256_store_pd(r, v);
+			return r[i];
+		}
+		static bool is_boxed(vec v) {
+			__m256i sign  = _mm256_set1_epi64x(INT64_MIN);
+			__m256i limit = _mm256_set1_epi64x(int64_t((uint64_t(boxed_limit) << 32) - 1) ^ INT64_MIN);
+			__m256i x     = _mm256_xor_si256(_mm256_castpd_si256(v), sign);
+			return !_mm256_testz_si256(_mm256_cmpgt_epi64(x, limit), _mm256_cmpgt_epi64(x, limit));
+		}
+	};
+#elif LI_HAS_SSE2
+	namespace simd {
+		using vec                     = __m128d;
+		static constexpr size_t lanes = 2;
+		static vec    load(const double* p) { return _mm_loadu_pd(p); }
+		static void   store(double* p, vec v) { _mm_storeu_pd(p, v); }
+		static vec    splat(double x) { return _mm_set1_pd(x); }
+		static vec    add(vec a, vec b) { return _mm_add_pd(a, b); }
+		static vec    mul(vec a, vec b) { return _mm_mul_pd(a, b); }
+		static vec    min(vec acc, vec x) { return _mm_min_pd(x, acc); }
+		static vec    max(vec acc, vec x) { return _mm_max_pd(x, acc); }
+		static double lane(vec v, size_t i) { return i ? _mm_cvtsd_f64(_mm_unpackhi_pd(v, v)) : _mm_cvtsd_f64(v); }
+		static bool   is_boxed(vec v) {
+			__m128i sign  = _mm_set1_epi32(INT32_MIN);
+			__m128i limit = _mm_set1_epi32(int32_t((boxed_limit - 1) ^ uint32_t(INT32_MIN)));
+			__m128i x     = _mm_xor_si128(_mm_castpd_si128(v), sign);
+			return _mm_movemask_ps(_mm_castsi128_ps(_mm_cmpgt_epi32(x, limit))) & 0b1010;
+		}
+	};
+#endif
+
+	// Contiguous view of an array as doubles, boxed ranges have to be checked for non-numbers.
+	//
+	struct number_range {
+		double* data   = nullptr;
+		msize_t length = 0;
+		bool    boxed  = false;
+
+		bool is_number(size_t i) const { return !boxed || any_t{li::bit_cast<uint64_t>(data[i])}.is_num(); }
+	};
+	static bool get_range(vm* L, any_t a, number_range& out, bool write) {
+		if (a.is_arr()) {
+			out = {(double*) a.as_arr()->begin(), a.as_arr()->size(), true};
+			return true;
+		} else if (a.is_tarr()) {
+			auto* t = a.as_tarr();
+			if (t->elem != type::any && t->elem != type::f64)
+				return false;
+			if (write)
+				t->own(L);
+			out = {(double*) t->data(), t->available(), t->elem == type::any};
+			return true;
+		}
+		return false;
+	}
+
+	// Reduction kernels, return false if a non-number is found. Reductions without an identity
+	// (min/max) have no result for an empty array.
+	//
+	struct op_sum {
+		static constexpr double init     = 0;
+		static constexpr bool   identity = true;
+		static double           scalar(double acc, double x) { return acc + x; }
+#if LI_HAS_SSE2
+		static simd::vec vec(simd::vec acc, simd::vec x) { return simd::add(acc, x); }
+#endif
+	};
+	struct op_min {
+		static constexpr double init     = +HUGE_VAL;
+		static constexpr bool   identity = false;
+		static double           scalar(double acc, double x) { return x < acc ? x : acc; }
+#if LI_HAS_SSE2
+		static simd::vec vec(simd::vec acc, simd::vec x) { return simd::min(acc, x); }
+#endif
+	};
+	struct op_max {
+		static constexpr double init     = -HUGE_VAL;
+		static constexpr bool   identity = false;
+		static double           scalar(double acc, double x) { return x > acc ? x : acc; }
+#if LI_HAS_SSE2
+		static simd::vec vec(simd::vec acc, simd::vec x) { return simd::max(acc, x); }
+#endif
+	};
+	template<typename Op>
+	static bool reduce(const number_range& r, double& result) {
+		double acc = Op::init;
+		size_t i   = 0;
+#if LI_HAS_SSE2
+		constexpr size_t step = 2 * simd::lanes;
+		if (r.length >= step) {
+			simd::vec a0 = simd::splat(Op::init);
+			simd::vec a1 = a0;
+			for (; i + step <= r.length; i += step) {
+				simd::vec x0 = simd::load(r.data + i);
+				simd::vec x1 = simd::load(r.data + i + simd::lanes);
+				if (r.boxed && (simd::is_boxed(x0) || simd::is_boxed(x1)))
+					return false;
+				a0 = Op::vec(a0, x0);
+				a1 = Op::vec(a1, x1);
+			}
+			a0 = Op::vec(a0, a1);
+			for (size_t l = 0; l != simd::lanes; l++)
+				acc = Op::scalar(acc, simd::lane(a0, l));
+		}
+#endif
+		for (; i != r.length; i++) {
+			if (!r.is_number(i))
+				return false;
+			acc = Op::scalar(acc, r.data[i]);
+		}
+		result = acc;
+		return true;
+	}
+	static bool dot(const number_range& a, const number_range& b, double& result) {
+		double acc = 0;
+		size_t i   = 0;
+#if LI_HAS_SSE2
+		simd::vec a0 = simd::splat(0);
+		simd::vec a1 = a0;
+		for (; i + 2 * simd::lanes <= a.length; i += 2 * simd::lanes) {
+			simd::vec x0 = simd::load(a.data + i);
+			simd::vec x1 = simd::load(a.data + i + simd::lanes);
+			simd::vec y0 = simd::load(b.data + i);
+			simd::vec y1 = simd::load(b.data + i + simd::lanes);
+			if ((a.boxed && (simd::is_boxed(x0) || simd::is_boxed(x1))) || (b.boxed && (simd::is_boxed(y0) || simd::is_boxed(y1))))
+				return false;
+			a0 = simd::add(a0, simd::mul(x0, y0));
+			a1 = simd::add(a1, simd::mul(x1, y1));
+		}
+		a0 = simd::add(a0, a1);
+		for (size_t l = 0; l != simd::lanes; l++)
+			acc += simd::lane(a0, l);
+#endif
+		for (; i != a.length; i++) {
+			if (!a.is_number(i) || !b.is_number(i))
+				return false;
+			acc += a.data[i] * b.data[i];
+		}
+		result = acc;
+		return true;
+	}
+
+	// Map kernels, the range is checked as a whole first so that failing leaves it unchanged.
+	//
+	static bool all_numbers(const number_range& r) {
+		size_t i = 0;
+		if (!r.boxed)
+			return true;
+#if LI_HAS_SSE2
+		for (; i + simd::lanes <= r.length; i += simd::lanes) {
+			if (simd::is_boxed(simd::load(r.data + i)))
+				return false;
+		}
+#endif
+		for (; i != r.length; i++) {
+			if (!r.is_number(i))
+				return false;
+		}
+		return true;
+	}
+	template<bool Mul>
+	static bool map_scalar(const number_range& r, double k) {
+		if (!all_numbers(r))
+			return false;
+		size_t i = 0;
+#if LI_HAS_SSE2
+		simd::vec kv = simd::splat(k);
+		for (; i + simd::lanes <= r.length; i += simd::lanes) {
+			simd::vec x = simd::load(r.data + i);
+			simd::store(r.data + i, Mul ? simd::mul(x, kv) : simd::add(x, kv));
+		}
+#endif
+		for (; i != r.length; i++)
+			r.data[i] = Mul ? r.data[i] * k : r.data[i] + k;
+		return true;
+	}
+
+	// Scalar fallback for typed arrays that are not stored as doubles.
+	//
+	template<typename F>
+	static void for_each_number(vm* L, tarray* t, F&& f) {
+		for (msize_t i = 0; i != t->available(); i++)
+			f(i, t->get(L, i).as_num());
+	}
+
+	// Library functions.
+	//
+	template<typename Op>
+	static any_t array_reduce(vm* L, any_t a) {
+		double       r = Op::init;
+		number_range range;
+		if (get_range(L, a, range, false)) {
+			if (!reduce<Op>(range, r))
+				return L->error("expected array of numbers");
+			if (!range.length && !Op::identity)
+				return nil;
+		} else if (a.is_tarr()) {
+			for_each_number(L, a.as_tarr(), [&](msize_t, double x) { r = Op::scalar(r, x); });
+			if (!a.as_tarr()->available() && !Op::identity)
+				return nil;
+		} else {
+			return L->error("expected array");
+		}
+		return any(r);
+	}
+	static any_t array_dot(vm* L, any_t a, any_t b) {
+		number_range ra, rb;
+		if (get_range(L, a, ra, false) && get_range(L, b, rb, false)) {
+			if (ra.length != rb.length)
+				return L->error("expected arrays of the same length");
+			double r;
+			if (!dot(ra, rb, r))
+				return L->error("expected array of numbers");
+			return any(r);
+		} else if ((a.is_arr() || a.is_tarr()) && (b.is_arr() || b.is_tarr())) {
+			auto len = [](any_t x) { return x.is_arr() ? x.as_arr()->size() : x.as_tarr()->available(); };
+			auto get = [&](any_t x, msize_t i) { return x.is_arr() ? x.as_arr()->get(L, i) : x.as_tarr()->get(L, i); };
+			if (len(a) != len(b))
+				return L->error("expected arrays of the same length");
+			double r = 0;
+			for (msize_t i = 0; i != len(a); i++) {
+				any x = get(a, i), y = get(b, i);
+				if (!x.is_num() || !y.is_num())
+					return L->error("expected array of numbers");
+				r += x.as_num() * y.as_num();
+			}
+			return any(r);
+		}
+		return L->error("expected two arrays");
+	}
+	static any_t array_fill(vm* L, any_t a, any_t v) {
+		if (a.is_arr()) {
+			std::fill_n(a.as_arr()->begin(), a.as_arr()->size(), any(v));
+		} else if (a.is_tarr()) {
+			auto* t = a.as_tarr();
+			if (!t->accepts(v))
+				return L->error("storing non-number or out-of-range value into typed array");
+			t->own(L);
+			if (t->elem == type::any)
+				std::fill_n((any*) t->data(), t->size(), any(v));
+			else if (t->elem == type::f64)
+				std::fill_n((double*) t->data(), t->size(), v.as_num());
+			else
+				for (msize_t i = 0; i != t->size(); i++)
+					t->set(L, i, v);
+		} else {
+			return L->error("expected array");
+		}
+		return a;
+	}
+	template<bool Mul>
+	static any_t array_map_scalar(vm* L, any_t a, any_t k) {
+		if (!k.is_num())
+			return L->error("expected number");
+		number_range range;
+		if (get_range(L, a, range, true)) {
+			if (!map_scalar<Mul>(range, k.as_num()))
+				return L->error("expected array of numbers");
+		} else if (a.is_tarr()) {
+			// Results are checked before any is stored so the array is left untouched on failure.
+			//
+			auto* t  = a.as_tarr();
+			bool  ok = true;
+			for_each_number(L, t, [&](msize_t, double x) { ok = ok && t->accepts(any(Mul ? x * k.as_num() : x + k.as_num())); });
+			if (!ok)
+				return L->error("storing non-number or out-of-range value into typed array");
+			t->own(L);
+			for_each_number(L, t, [&](msize_t i, double x) { t->set(L, i, any(Mul ? x * k.as_num() : x + k.as_num())); });
+		} else {
+			return L->error("expected array");
+		}
+		return a;
+	}
+
+	// Sorting, numbers are sorted as integer keys with the branchless partitioning, other arrays by value.
+	//
+	template<typename U>
+	static U to_sort_key(U u) {
+		constexpr U sign = U(1) << (sizeof(U) * 8 - 1);
+		return (u & sign) ? ~u : u | sign;
+	}
+	template<typename U>
+	static U from_sort_key(U k) {
+		constexpr U sign = U(1) << (sizeof(U) * 8 - 1);
+		return (k & sign) ? k & ~sign : ~k;
+	}
+	template<typename U>
+	static void sort_floats(U* begin, U* end) {
+		for (U* it = begin; it != end; ++it)
+			*it = to_sort_key(*it);
+		util::pdqsort<true>(begin, end, std::less<U>{});
+		for (U* it = begin; it != end; ++it)
+			*it = from_sort_key(*it);
+	}
+	static void sort_boxed(any* begin, any* end) {
+		if (all_numbers({(double*) begin, msize_t(end - begin), true})) {
+			sort_floats((uint64_t*) begin, (uint64_t*) end);
+		} else if (std::all_of(begin, end, [](any x) { return x.is_str(); })) {
+			util::pdqsort(begin, end, [](any a, any b) { return a.as_str() != b.as_str() && a.as_str()->view() < b.as_str()->view(); });
+		} else {
+			util::pdqsort(begin, end, [](any a, any b) { return omap::less(a, b); });
+		}
+	}
+	static void sort_typed(tarray* t) {
+		auto* p = t->data();
+		auto  n = t->size();
+		switch (t->elem) {
+			case type::any: return sort_boxed((any*) p, (any*) p + n);
+			case type::f64: return sort_floats((uint64_t*) p, (uint64_t*) p + n);
+			case type::f32: return sort_floats((uint32_t*) p, (uint32_t*) p + n);
+			case type::i64: return util::pdqsort<true>((int64_t*) p, (int64_t*) p + n, std::less<int64_t>{});
+			case type::i32: return util::pdqsort<true>((int32_t*) p, (int32_t*) p + n, std::less<int32_t>{});
+			case type::i16: return util::pdqsort<true>((int16_t*) p, (int16_t*) p + n, std::less<int16_t>{});
+			case type::i8: return util::pdqsort<true>((int8_t*) p, (int8_t*) p + n, std::less<int8_t>{});
+			default: assume_unreachable();
+		}
+	}
+
+	// Script comparators are called directly through the JIT entry if there is one, a numeric result is compared
+	// against zero and anything else is coerced to bool. An exception stops any further calls.
+	//
+	struct script_comparator {
+		vm*     L;
+		any     fn;
+		nfunc_t entry;
+		bool    failed = false;
+
+		bool operator()(any a, any b) {
+			if (failed)
+				return false;
+			any* reset = L->stack_top;
+			L->push_stack(b);
+			L->push_stack(a);
+			L->push_stack(nil);
+			L->push_stack(fn);
+			call_frame cf{.caller_pc = msize_t(L->last_vm_caller.caller_pc | FRAME_C_FLAG), .stack_pos = L->last_vm_caller.stack_pos};
+			L->push_stack(any_t{li::bit_cast<uint64_t>(cf)});
+			any r       = entry(L, &L->stack_top[-1 - FRAME_SIZE], 2);
+			L->stack_top = reset;
+			if (r.is_exc()) {
+				failed = true;
+				return false;
+			}
+			return r.is_num() ? r.as_num() < 0 : r.coerce_bool();
+		}
+	};
+	static any_t array_sort_by(vm* L, any_t a, function* f) {
+		auto len = [&]() { return a.is_arr() ? a.as_arr()->size() : a.as_tarr()->available(); };
+		auto get = [&](msize_t i) { return a.is_arr() ? a.as_arr()->get(L, i) : a.as_tarr()->get(L, i); };
+
+		// Sort a copy since the comparator may modify the array, the values are kept alive by a pinned array.
+		//
+		msize_t          n   = len();
+		array*           pin = array::create(L, n);
+		std::vector<any> list(n);
+		for (msize_t i = 0; i != n; i++)
+			list[i] = pin->begin()[i] = get(i);
+		L->push_stack(pin);
+
+		script_comparator comp{L, f, f->is_jit() ? f->invoke : &vm_invoke};
+		util::pdqsort(list.data(), list.data() + n, std::ref(comp));
+		L->pop_stack();
+		if (comp.failed)
+			return exception_marker;
+		if (len() != n)
+			return L->error("array modified during sort");
+
+		if (a.is_arr()) {
+			std::copy(list.begin(), list.end(), a.as_arr()->begin());
+		} else {
+			for (msize_t i = 0; i != n; i++)
+				a.as_tarr()->set(L, i, list[i]);
+		}
+		return a;
+	}
+	static any_t array_sort(vm* L, any_t a, any_t cmp) {
+		if (!a.is_arr() && !a.is_tarr())
+			return L->error("expected array");
+		if (cmp != nil) {
+			if (!cmp.is_fn())
+				return L->error("expected comparator function");
+			return array_sort_by(L, a, cmp.as_fn());
+		}
+		if (a.is_arr()) {
+			sort_boxed(a.as_arr()->begin(), a.as_arr()->end());
+		} else {
+			a.as_tarr()->own(L);
+			sort_typed(a.as_tarr());
+		}
+		return a;
+	}
+
+	// Native entries, the typed overloads let the JIT call the kernels without going through the VM.
+	//
+	static any_t LI_CC array_sum_arr(vm* L, array* a) { return array_reduce<op_sum>(L, any(a)); }
+	static any_t LI_CC array_sum_tarr(vm* L, tarray* a) { return array_reduce<op_sum>(L, any(a)); }
+	static any_t LI_CC array_min_arr(vm* L, array* a) { return array_reduce<op_min>(L, any(a)); }
+	static any_t LI_CC array_min_tarr(vm* L, tarray* a) { return array_reduce<op_min>(L, any(a)); }
+	static any_t LI_CC array_max_arr(vm* L, array* a) { return array_reduce<op_max>(L, any(a)); }
+	static any_t LI_CC array_max_tarr(vm* L, tarray* a) { return array_reduce<op_max>(L, any(a)); }
+	static any_t LI_CC array_dot_arr(vm* L, array* a, array* b) { return array_dot(L, any(a), any(b)); }
+	static any_t LI_CC array_dot_tarr(vm* L, tarray* a, tarray* b) { return array_dot(L, any(a), any(b)); }
+	static any_t LI_CC array_fill_arr(vm* L, array* a, any_t v) { return array_fill(L, any(a), v); }
+	static any_t LI_CC array_fill_tarr(vm* L, tarray* a, any_t v) { return array_fill(L, any(a), v); }
+	static any_t LI_CC array_add_arr(vm* L, array* a, double k) { return array_map_scalar<false>(L, any(a), any(k)); }
+	static any_t LI_CC array_add_tarr(vm* L, tarray* a, double k) { return array_map_scalar<false>(L, any(a), any(k)); }
+	static any_t LI_CC array_mul_arr(vm* L, array* a, double k) { return array_map_scalar<true>(L, any(a), any(k)); }
+	static any_t LI_CC array_mul_tarr(vm* L, tarray* a, double k) { return array_map_scalar<true>(L, any(a), any(k)); }
+	static any_t LI_CC array_sort_arr(vm* L, array* a) { return array_sort(L, any(a), nil); }
+	static any_t LI_CC array_sort_tarr(vm* L, tarray* a) { return array_sort(L, any(a), nil); }
+
+	static any_t arg(any* args, slot_t n, slot_t i) { return i < n ? args[-i] : any(nil); }
+
+	static util::native_function array_sum = {
+		 func_attr_pure | func_attr_c_takes_vm,
+		 "arrays.sum",
+		 [](vm* L, any* args, slot_t n) { return array_reduce<op_sum>(L, arg(args, n, 0)); },
+		 {
+			  nfunc_overload{li::bit_cast<const void*>(&array_sum_arr), {type::arr}, type::any},
+			  nfunc_overload{li::bit_cast<const void*>(&array_sum_tarr), {type::tarr}, type::any},
+		 },
+	};
+	static util::native_function array_min = {
+		 func_attr_pure | func_attr_c_takes_vm,
+		 "arrays.min",
+		 [](vm* L, any* args, slot_t n) { return array_reduce<op_min>(L, arg(args, n, 0)); },
+		 {
+			  nfunc_overload{li::bit_cast<const void*>(&array_min_arr), {type::arr}, type::any},
+			  nfunc_overload{li::bit_cast<const void*>(&array_min_tarr), {type::tarr}, type::any},
+		 },
+	};
+	static util::native_function array_max = {
+		 func_attr_pure | func_attr_c_takes_vm,
+		 "arrays.max",
+		 [](vm* L, any* args, slot_t n) { return array_reduce<op_max>(L, arg(args, n, 0)); },
+		 {
+			  nfunc_overload{li::bit_cast<const void*>(&array_max_arr), {type::arr}, type::any},
+			  nfunc_overload{li::bit_cast<const void*>(&array_max_tarr), {type::tarr}, type::any},
+		 },
+	};
+	static util::native_function array_dot_fn = {
+		 func_attr_pure | func_attr_c_takes_vm,
+		 "arrays.dot",
+		 [](vm* L, any* args, slot_t n) { return array_dot(L, arg(args, n, 0), arg(args, n, 1)); },
+		 {
+			  nfunc_overload{li::bit_cast<const void*>(&array_dot_arr), {type::arr, type::arr}, type::any},
+			  nfunc_overload{li::bit_cast<const void*>(&array_dot_tarr), {type::tarr, type::tarr}, type::any},
+		 },
+	};
+	static util::native_function array_fill_fn = {
+		 func_attr_sideeffect | func_attr_c_takes_vm,
+		 "arrays.fill",
+		 [](vm* L, any* args, slot_t n) { return array_fill(L, arg(args, n, 0), arg(args, n, 1)); },
+		 {
+			  nfunc_overload{li::bit_cast<const void*>(&array_fill_arr), {type::arr, type::any}, type::any},
+			  nfunc_overload{li::bit_cast<const void*>(&array_fill_tarr), {type::tarr, type::any}, type::any},
+		 },
+	};
+	static util::native_function array_add = {
+		 func_attr_sideeffect | func_attr_c_takes_vm,
+		 "arrays.add",
+		 [](vm* L, any* args, slot_t n) { return array_map_scalar<false>(L, arg(args, n, 0), arg(args, n, 1)); },
+		 {
+			  nfunc_overload{li::bit_cast<const void*>(&array_add_arr), {type::arr, type::f64}, type::any},
+			  nfunc_overload{li::bit_cast<const void*>(&array_add_tarr), {type::tarr, type::f64}, type::any},
+		 },
+	};
+	static util::native_function array_mul = {
+		 func_attr_sideeffect | func_attr_c_takes_vm,
+		 "arrays.mul",
+		 [](vm* L, any* args, slot_t n) { return array_map_scalar<true>(L, arg(args, n, 0), arg(args, n, 1)); },
+		 {
+			  nfunc_overload{li::bit_cast<const void*>(&array_mul_arr), {type::arr, type::f64}, type::any},
+			  nfunc_overload{li::bit_cast<const void*>(&array_mul_tarr), {type::tarr, type::f64}, type::any},
+		 },
+	};
+	static util::native_function array_sort_fn = {
+		 func_attr_sideeffect | func_attr_c_takes_vm,
+		 "arrays.sort",
+		 [](vm* L, any* args, slot_t n) {
+			 vm_stack_guard _g{L, args};
+			 return array_sort(L, arg(args, n, 0), arg(args, n, 1));
+		 },
+		 {
+			  nfunc_overload{li::bit_cast<const void*>(&array_sort_arr), {type::arr}, type::any},
+			  nfunc_overload{li::bit_cast<const void*>(&array_sort_tarr), {type::tarr}, type::any},
+		 },
+	};
+
+	// Registers the array library.
+	//
+	void register_array(vm* L) {
+		array_sum.export_into(L);
+		array_min.export_into(L);
+		array_max.export_into(L);
+		array_dot_fn.export_into(L);
+		array_fill_fn.export_into(L);
+		array_add.export_into(L);
+		array_mul.export_into(L);
+		array_sort_fn.export_into(L);
+	}
+};
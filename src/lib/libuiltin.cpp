@@ -7,6 +7,8 @@
 #include <vm/string.hpp>
 #include <vm/table.hpp>
 #include <vm/object.hpp>
+#include <vm/omap.hpp>
+#include <vm/tarray.hpp>
 
 // Include arch-specific header if relevant for optimizations.
 //
@@ -25,14 +27,17 @@ namespace li::lib {
 
 	static table* LI_CC    builtin_dup_table(vm* L, table* a) { return a->duplicate(L); }
 	static array* LI_CC    builtin_dup_array(vm* L, array* a) { return a->duplicate(L); }
+	static tarray* LI_CC   builtin_dup_tarray(vm* L, tarray* a) { return a->duplicate(L); }
 	static function* LI_CC builtin_dup_function(vm* L, function* a) { return a->duplicate(L); }
 	static object* LI_CC   builtin_dup_object(vm* L, object* a) { return a->duplicate(L); }
-	static any_t LI_CC     builtin_dup_else(vm* L, any_t v) { return v; }
+	static any_t LI_CC     builtin_dup_else(vm* L, any_t v) { return v.is_omap() ? any(v.as_omap()->duplicate(L)) : any(v); }
 
 	static any_t builtin_dup_vm(vm* L, any* args, slot_t nargs) {
 		any a = args[1];
 		if (a.is_arr()) {
 			return any(builtin_dup_array(L, a.as_arr()));
+		} else if (a.is_tarr()) {
+			return any(builtin_dup_tarray(L, a.as_tarr()));
 		} else if (a.is_tbl()) {
 			return any(builtin_dup_table(L, a.as_tbl()));
 		} else if (a.is_fn()) {
@@ -45,14 +50,22 @@ namespace li::lib {
 	}
 
 	static msize_t LI_CC builtin_len_array(vm* L, array* a) { return a->length; }
+	static msize_t LI_CC builtin_len_tarray(vm* L, tarray* a) { return a->available(); }
 	static msize_t LI_CC builtin_len_table(vm* L, table* t) { return t->active_count; }
 	static msize_t LI_CC builtin_len_string(vm* L, string* s) { return s->length; }
-	static any_t LI_CC   builtin_len_else(vm* L, any_t a) { return L->error("expected iterable"); }
+	static any_t LI_CC   builtin_len_else(vm* L, any_t a) {
+		if (a.is_omap()) {
+			return any((number) a.as_omap()->size());
+		}
+		return L->error("expected iterable");
+	}
 
 	static any_t builtin_len_vm(vm* L, any* args, slot_t nargs) {
 		any a = args[1];
 		if (a.is_arr()) {
 			return any((number) builtin_len_array(L, a.as_arr()));
+		} else if (a.is_tarr()) {
+			return any((number) builtin_len_tarray(L, a.as_tarr()));
 		} else if (a.is_tbl()) {
 			return any((number) builtin_len_table(L, a.as_tbl()));
 		} else if (a.is_str()) {
@@ -105,6 +118,13 @@ namespace li::lib {
 	}
 
 	static void LI_CC  builtin_push_array(vm* L, array* dst, any_t val) { dst->push(L, val); }
+	static any_t LI_CC builtin_push_tarray(vm* L, tarray* dst, any_t val) {
+		if (!dst->accepts(val)) {
+			return L->error("storing non-number or out-of-range value into typed array");
+		}
+		dst->push(L, val);
+		return nil;
+	}
 	static any_t LI_CC builtin_push_else(vm* L) { return L->error("push expected array"); }
 
 	static any_t builtin_push_vm(vm* L, any* args, slot_t nargs) {
@@ -116,21 +136,99 @@ namespace li::lib {
 		if (dst.is_arr()) {
 			builtin_push_array(L, dst.as_arr(), val);
 			return nil;
+		} else if (dst.is_tarr()) {
+			return builtin_push_tarray(L, dst.as_tarr(), val);
 		}
 		return builtin_push_else(L);
 	}
 
 	static any_t LI_CC builtin_pop_array(vm* L, array* dst) { return dst->pop(); }
+	static any_t LI_CC builtin_pop_tarray(vm* L, tarray* dst) { return dst->pop(L); }
 	static any_t LI_CC builtin_pop_else(vm* L) { return L->error("pop expected array"); }
 
 	static any_t builtin_pop_vm(vm* L, any* args, slot_t nargs) {
 		any dst = args[1];
 		if (dst.is_arr()) {
 			return builtin_pop_array(L, dst.as_arr());
+		} else if (dst.is_tarr()) {
+			return builtin_pop_tarray(L, dst.as_tarr());
 		}
 		return builtin_pop_else(L);
 	}
 
+	static void LI_CC  builtin_push_front_array(vm* L, array* dst, any_t val) { dst->push_front(L, val); }
+	static any_t LI_CC builtin_push_front_tarray(vm* L, tarray* dst, any_t val) {
+		if (!dst->accepts(val)) {
+			return L->error("storing non-number or out-of-range value into typed array");
+		}
+		any v = val;
+		dst->insert(L, 0, &v, 1);
+		return nil;
+	}
+	static any_t LI_CC builtin_push_front_else(vm* L) { return L->error("push_front expected array"); }
+
+	static any_t builtin_push_front_vm(vm* L, any* args, slot_t nargs) {
+		if (nargs < 1) {
+			return L->error("push_front expects 1 argument");
+		}
+		any val = args[0];
+		any dst = args[1];
+		if (dst.is_arr()) {
+			builtin_push_front_array(L, dst.as_arr(), val);
+			return nil;
+		} else if (dst.is_tarr()) {
+			return builtin_push_front_tarray(L, dst.as_tarr(), val);
+		}
+		return builtin_push_front_else(L);
+	}
+
+	static any_t LI_CC builtin_pop_front_array(vm* L, array* dst) { return dst->pop_front(); }
+	static any_t LI_CC builtin_pop_front_tarray(vm* L, tarray* dst) {
+		any r = dst->get(L, 0);
+		dst->remove(L, 0, 1);
+		return r;
+	}
+	static any_t LI_CC builtin_pop_front_else(vm* L) { return L->error("pop_front expected array"); }
+
+	static any_t builtin_pop_front_vm(vm* L, any* args, slot_t nargs) {
+		any dst = args[1];
+		if (dst.is_arr()) {
+			return builtin_pop_front_array(L, dst.as_arr());
+		} else if (dst.is_tarr()) {
+			return builtin_pop_front_tarray(L, dst.as_tarr());
+		}
+		return builtin_pop_front_else(L);
+	}
+
+	static void LI_CC  builtin_compact_table(vm* L, table* dst) { dst->compact(L); }
+	static any_t LI_CC builtin_compact_else(vm* L) { return L->error("compact expected table"); }
+
+	static any_t builtin_compact_vm(vm* L, any* args, slot_t nargs) {
+		any dst = args[1];
+		if (dst.is_tbl()) {
+			builtin_compact_table(L, dst.as_tbl());
+			return nil;
+		}
+		return builtin_compact_else(L);
+	}
+
+	// Parses a weak table mode, a combination of 'k' and 'v'.
+	//
+	static bool parse_weak_mode(any_t mode, bool& keys, bool& values) {
+		keys = values = false;
+		if (!mode.is_str())
+			return false;
+		for (char c : mode.as_str()->view()) {
+			if (c == 'k')
+				keys = true;
+			else if (c == 'v')
+				values = true;
+			else
+				return false;
+		}
+		return true;
+	}
+
 	static bool LI_CC builtin_in_arr_unk(vm* L, array* i, any_t v) {
 		for (auto& k : *i)
 			if (k == v)
@@ -188,6 +286,7 @@ namespace li::lib {
 
 		 {
 			  nfunc_overload{li::bit_cast<const void*>(&builtin_push_array), {type::arr, type::any}, type::none},
+			  nfunc_overload{li::bit_cast<const void*>(&builtin_push_tarray), {type::tarr, type::any}, type::any},
 			  nfunc_overload{li::bit_cast<const void*>(&builtin_push_else), {}, type::exc},
 		 },
 	};
@@ -198,9 +297,42 @@ namespace li::lib {
 
 		 {
 			  nfunc_overload{li::bit_cast<const void*>(&builtin_pop_array), {type::arr}, type::any},
+			  nfunc_overload{li::bit_cast<const void*>(&builtin_pop_tarray), {type::tarr}, type::any},
 			  nfunc_overload{li::bit_cast<const void*>(&builtin_pop_else), {}, type::exc},
 		 },
 	};
+	util::native_function detail::builtin_push_front = {
+		 func_attr_sideeffect | func_attr_c_takes_vm | func_attr_c_takes_self,
+		 "builtin.push_front",
+		 &builtin_push_front_vm,
+
+		 {
+			  nfunc_overload{li::bit_cast<const void*>(&builtin_push_front_array), {type::arr, type::any}, type::none},
+			  nfunc_overload{li::bit_cast<const void*>(&builtin_push_front_tarray), {type::tarr, type::any}, type::any},
+			  nfunc_overload{li::bit_cast<const void*>(&builtin_push_front_else), {}, type::exc},
+		 },
+	};
+	util::native_function detail::builtin_pop_front = {
+		 func_attr_sideeffect | func_attr_c_takes_vm | func_attr_c_takes_self,
+		 "builtin.pop_front",
+		 &builtin_pop_front_vm,
+
+		 {
+			  nfunc_overload{li::bit_cast<const void*>(&builtin_pop_front_array), {type::arr}, type::any},
+			  nfunc_overload{li::bit_cast<const void*>(&builtin_pop_front_tarray), {type::tarr}, type::any},
+			  nfunc_overload{li::bit_cast<const void*>(&builtin_pop_front_else), {}, type::exc},
+		 },
+	};
+	util::native_function detail::builtin_compact = {
+		 func_attr_sideeffect | func_attr_c_takes_vm | func_attr_c_takes_self,
+		 "builtin.compact",
+		 &builtin_compact_vm,
+
+		 {
+			  nfunc_overload{li::bit_cast<const void*>(&builtin_compact_table), {type::tbl}, type::none},
+			  nfunc_overload{li::bit_cast<const void*>(&builtin_compact_else), {}, type::exc},
+		 },
+	};
 	util::native_function detail::builtin_str = {
 		 func_attr_pure | func_attr_c_takes_vm | func_attr_c_takes_self,
 		 "builtin.str",
@@ -239,6 +371,7 @@ namespace li::lib {
 			  nfunc_overload{li::bit_cast<const void*>(&builtin_len_array), {type::arr}, type::i32},
 			  nfunc_overload{li::bit_cast<const void*>(&builtin_len_table), {type::tbl}, type::i32},
 			  nfunc_overload{li::bit_cast<const void*>(&builtin_len_string), {type::str}, type::i32},
+			  nfunc_overload{li::bit_cast<const void*>(&builtin_len_tarray), {type::tarr}, type::i32},
 			  nfunc_overload{li::bit_cast<const void*>(&builtin_len_else), {type::any}, type::any},
 		 },
 	};
@@ -248,6 +381,7 @@ namespace li::lib {
 		 &builtin_dup_vm,
 		 {
 			  nfunc_overload{li::bit_cast<const void*>(&builtin_dup_array), {type::arr}, type::arr},
+			  nfunc_overload{li::bit_cast<const void*>(&builtin_dup_tarray), {type::tarr}, type::tarr},
 			  nfunc_overload{li::bit_cast<const void*>(&builtin_dup_table), {type::tbl}, type::tbl},
 			  nfunc_overload{li::bit_cast<const void*>(&builtin_dup_function), {type::fn}, type::fn},
 			  nfunc_overload{li::bit_cast<const void*>(&builtin_dup_object), {type::obj}, type::obj},
@@ -285,6 +419,9 @@ namespace li::lib {
 		builtin_join.export_into(L);
 		builtin_push.export_into(L);
 		builtin_pop.export_into(L);
+		builtin_push_front.export_into(L);
+		builtin_pop_front.export_into(L);
+		builtin_compact.export_into(L);
 
 		util::export_as(L, "builtin.print", [](vm* L, any* args, slot_t n) {
 			for (int32_t i = 0; i != n; i++) {
@@ -323,15 +460,134 @@ namespace li::lib {
 			if (n && args->is_num()) {
 				r = (uint32_t) (uint64_t) std::abs(args->as_num());
 			}
-			return L->ok(table::create(L, r));
+			auto* t = table::create(L, r);
+			if (n >= 2) {
+				bool keys, values;
+				if (!parse_weak_mode(args[-1], keys, values))
+					return L->error("expected weak mode 'k', 'v' or 'kv'");
+				t->set_weak(L, keys, values);
+			}
+			return L->ok(t);
+		});
+		util::export_as(L, "builtin.weak", [](vm* L, any* args, slot_t n) {
+			bool keys, values;
+			if (!args[1].is_tbl()) {
+				return L->error("weak expected table");
+			}
+			if (!n || !parse_weak_mode(args[0], keys, values)) {
+				return L->error("expected weak mode 'k', 'v' or 'kv'");
+			}
+			args[1].as_tbl()->set_weak(L, keys, values);
+			return L->ok(args[1]);
+		});
+		util::export_as(L, "builtin.@omap", [](vm* L, any*, slot_t) { return L->ok(omap::create(L)); });
+		util::export_as(L, "builtin.lower_bound", [](vm* L, any* args, slot_t n) {
+			if (!args[1].is_omap()) {
+				return L->error("lower_bound expected ordered map");
+			}
+			if (!n || args[0] == nil) {
+				return L->error("lower_bound expects a key");
+			}
+			any   k = nil, v;
+			auto* m = args[1].as_omap();
+			m->at(m->lower_bound(args[0]), k, v);
+			return L->ok(k);
+		});
+		util::export_as(L, "builtin.range", [](vm* L, any* args, slot_t n) {
+			if (!args[1].is_omap()) {
+				return L->error("range expected ordered map");
+			}
+			any lo = n >= 1 ? args[0] : any(nil);
+			any hi = n >= 2 ? args[-1] : any(nil);
+			return L->ok(args[1].as_omap()->range(L, lo, hi));
 		});
 		util::export_as(L, "builtin.@array", [](vm* L, any* args, slot_t n) {
 			uint32_t r = 0;
 			if (n && args->is_num()) {
 				r = (uint32_t) (uint64_t) std::abs(args->as_num());
 			}
+			if (n >= 2) {
+				li::type t;
+				if (!tarray::parse_type(args[-1], t))
+					return L->error("expected element type 'f64', 'f32', 'i64', 'i32', 'i16' or 'i8'");
+				return L->ok(tarray::create(L, t, r));
+			}
 			return L->ok(array::create(L, r));
 		});
+		util::export_as(L, "builtin.slice", [](vm* L, any* args, slot_t n) {
+			msize_t begin = 0, end = UINT32_MAX;
+			if (n >= 1 && args[0].is_num()) {
+				begin = (msize_t) std::clamp(args[0].as_num(), 0.0, double(UINT32_MAX));
+			}
+			if (n >= 2 && args[-1].is_num()) {
+				end = (msize_t) std::clamp(args[-1].as_num(), 0.0, double(UINT32_MAX));
+			}
+			auto* r = tarray::slice(L, args[1], begin, end);
+			if (!r) {
+				return L->error("slice expected array");
+			}
+			return L->ok(r);
+		});
+		util::export_as(L, "builtin.insert", [](vm* L, any* args, slot_t n) {
+			if (!args[1].is_arr() && !args[1].is_tarr()) {
+				return L->error("insert expected array");
+			}
+			if (n < 1 || !args[0].is_num()) {
+				return L->error("insert expects an index");
+			}
+
+			// Values are in reverse order on the stack, flip them in place to insert them with a single move.
+			//
+			any* first = &args[-(n - 1)];
+			any* last  = &args[0];
+			std::reverse(first, last);
+			number idx = args[0].as_num();
+			bool   ok;
+			if (args[1].is_arr()) {
+				ok = idx >= 0 && args[1].as_arr()->insert(L, msize_t(idx), first, msize_t(n - 1));
+			} else {
+				auto* arr = args[1].as_tarr();
+				if (!std::all_of(first, last, [&](any v) { return arr->accepts(v); })) {
+					return L->error("storing non-number or out-of-range value into typed array");
+				}
+				ok = idx >= 0 && arr->insert(L, msize_t(idx), first, msize_t(n - 1));
+			}
+			if (!ok) {
+				return L->error("insert index out of range");
+			}
+			return L->ok();
+		});
+		util::export_as(L, "builtin.remove", [](vm* L, any* args, slot_t n) {
+			if (!args[1].is_arr() && !args[1].is_tarr()) {
+				return L->error("remove expected array");
+			}
+			if (n < 1 || !args[0].is_num()) {
+				return L->error("remove expects an index");
+			}
+			msize_t count = 1;
+			if (n >= 2 && args[-1].is_num()) {
+				count = (msize_t) std::clamp(args[-1].as_num(), 0.0, double(UINT32_MAX));
+			}
+			number idx = args[0].as_num();
+			if (idx < 0) {
+				return L->error("remove index out of range");
+			}
+			any  first;
+			bool ok;
+			if (args[1].is_arr()) {
+				auto* arr = args[1].as_arr();
+				first     = idx < arr->size() ? arr->begin()[msize_t(idx)] : any(nil);
+				ok        = arr->remove(msize_t(idx), count);
+			} else {
+				auto* arr = args[1].as_tarr();
+				first     = arr->get(L, msize_t(idx));
+				ok        = arr->remove(L, msize_t(idx), count);
+			}
+			if (!ok) {
+				return L->error("remove index out of range");
+			}
+			return L->ok(first);
+		});
 		util::export_as(L, "builtin.assert", [](vm* L, any* args, slot_t n) {
 			vm_stack_guard _g{L, args};
 			if (!n || args->coerce_bool())
@@ -17,65 +17,100 @@
 namespace li::lib {
 	using namespace ir;
 
+	// Compiles the function prototype, returns null if it cannot be compiled.
+	//
+	static jfunction* compile(vm* L, function_proto* f, bool verbose, bc::pos osr_entry = bc::no_pos) {
+		auto proc = lift_bc(L, f, osr_entry);
+		if (!proc) {
+			return nullptr;
+		}
+		opt::lift_phi(proc.get());
+		opt::schedule_gc(proc.get());
+
+		opt::fold_constant(proc.get());
+		opt::fold_identical(proc.get());
+		opt::dce(proc.get());
+		opt::cfg(proc.get());
+
+		opt::type_split_cfg(proc.get());
+		opt::type_inference(proc.get());
+		opt::fold_constant(proc.get());
+		opt::fold_identical(proc.get());
+		opt::dce(proc.get());
+		opt::cfg(proc.get());
+
+		// empty pass
+		opt::type_inference(proc.get());
+		opt::fold_constant(proc.get());
+		opt::fold_identical(proc.get());
+		opt::dce(proc.get());
+		opt::cfg(proc.get());
+
+		opt::prepare_for_mir(proc.get());
+		opt::type_inference(proc.get());
+		opt::fold_constant(proc.get());
+		opt::fold_identical(proc.get());
+		opt::dce(proc.get());
+		opt::cfg(proc.get());
+
+		opt::finalize_for_mir(proc.get());
+		if (verbose)
+			proc->print();
+
+		auto mp = lift_ir(proc.get());
+
+		opt::remove_redundant_setcc(mp.get());
+		opt::allocate_registers(mp.get());
+		if (verbose)
+			mp->print();
+
+		// hoist table fields even if it escapes
+		// move stuff out of loops
+		// type inference
+		// constant folding
+		// escape analysis
+		// loop analysis
+		// handling of frozen tables + add builtin tables
+		return assemble_ir(mp.get());
+	}
+
 	// Turns jit on or off.
 	//
-	void jit_on(vm* L, function* f, bool verbose) {
-		if (!f->proto->jfunc) {
-			auto proc = lift_bc(L, f->proto);
-			opt::lift_phi(proc.get());
-			opt::schedule_gc(proc.get());
-
-			opt::fold_constant(proc.get());
-			opt::fold_identical(proc.get());
-			opt::dce(proc.get());
-			opt::cfg(proc.get());
-
-			opt::type_split_cfg(proc.get());
-			opt::type_inference(proc.get());
-			opt::fold_constant(proc.get());
-			opt::fold_identical(proc.get());
-			opt::dce(proc.get());
-			opt::cfg(proc.get());
-
-			// empty pass
-			opt::type_inference(proc.get());
-			opt::fold_constant(proc.get());
-			opt::fold_identical(proc.get());
-			opt::dce(proc.get());
-			opt::cfg(proc.get());
-
-			opt::prepare_for_mir(proc.get());
-			opt::type_inference(proc.get());
-			opt::fold_constant(proc.get());
-			opt::fold_identical(proc.get());
-			opt::dce(proc.get());
-			opt::cfg(proc.get());
-
-			opt::finalize_for_mir(proc.get());
-			if (verbose)
-				proc->print();
-
-			auto mp = lift_ir(proc.get());
-
-			opt::remove_redundant_setcc(mp.get());
-			opt::allocate_registers(mp.get());
-			if (verbose)
-				mp->print();
-
-			f->proto->jfunc = assemble_ir(mp.get());
-			//
-			//
-
-			// hoist table fields even if it escapes
-			// move stuff out of loops
-			// type inference
-			// constant folding
-			// escape analysis
-			// loop analysis
-			// handling of frozen tables + add builtin tables
+	bool jit_on(vm* L, function* f, bool verbose) {
+		auto* p = f->proto;
+		if (p->attr & func_attr_no_jit) {
+			return false;
+		}
+		if (!p->jfunc) {
+			p->jfunc = compile(L, p, verbose);
+			if (!p->jfunc) {
+				p->attr |= func_attr_no_jit;
+				return false;
+			}
+		}
+		f->invoke = (nfunc_t) &p->jfunc->code[0];
+		return true;
+	}
+
+	// Compiles an entry point continuing the function from the given loop header for on-stack replacement.
+	//
+	jfunction* jit_osr(vm* L, function* f, bc::pos pc, bool verbose) {
+		auto* p = f->proto;
+		if (p->attr & func_attr_no_jit) {
+			return nullptr;
 		}
 
-		f->invoke = (nfunc_t) &f->proto->jfunc->code[0];
+		// Keep the first entry we compiled since there may be activations still running it.
+		//
+		if (p->osr_jfunc) {
+			return p->osr_pc == pc ? p->osr_jfunc : nullptr;
+		}
+		p->osr_jfunc = compile(L, p, verbose, pc);
+		p->osr_pc    = pc;
+		if (!p->osr_jfunc) {
+			p->attr |= func_attr_no_jit;
+		}
+		return p->osr_jfunc;
 	}
 	void jit_off(vm* L, function* f) { f->invoke = &vm_invoke; }
 
@@ -84,7 +119,9 @@ namespace li::lib {
 			return L->error("expected vfunction.");
 		}
 		bool verbose = n > 1 && args[-1].coerce_bool();
-		jit_on(L, args->as_fn(), verbose);
+		if (!jit_on(L, args->as_fn(), verbose)) {
+			return L->error("function cannot be compiled.");
+		}
 		return L->ok();
 	}
 	static any_t jit_off_v(vm* L, any* args, slot_t n) {
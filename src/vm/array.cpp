@@ -25,17 +25,34 @@ namespace li {
 		memcpy(begin() + pos, other->begin(), other->size() * sizeof(any));
 	}
 
+	// Moves the elements into a new storage of the given size, starting at the given slot.
+	//
+	static void relocate(vm* L, array* a, msize_t slots, msize_t head) {
+		auto* old_list = a->storage;
+		auto* new_list = L->alloc<array_store>(sizeof(any) * slots);
+		if (old_list) {
+			memcpy(new_list->entries + head, a->begin(), a->size() * sizeof(any));
+			L->gc.free(L, old_list);
+		}
+		a->storage = new_list;
+		a->head    = head;
+	}
+
 	// Reserve and resize.
+	// - Space freed at the front is reclaimed instead of growing once it is larger than the elements to move.
 	//
 	void array::reserve(vm* L, msize_t n) {
 		if (!storage) {
 			storage = L->alloc<array_store>(n * sizeof(any));
-		} else if (msize_t c = capacity(); n > c) {
-			msize_t new_capacity = std::max(n, c + (c >> 1));
-			auto*  old_list     = storage;
-			storage             = L->alloc<array_store>(sizeof(any) * new_capacity);
-			memcpy(storage->entries, old_list->entries, c * sizeof(any));
-			L->gc.free(L, old_list);
+			head    = 0;
+		} else if (n > capacity()) {
+			msize_t c = slots();
+			if (n <= c && head >= length) {
+				memmove(storage->entries, begin(), length * sizeof(any));
+				head = 0;
+			} else {
+				relocate(L, this, std::max(n, c + (c >> 1)), 0);
+			}
 		}
 	}
 	void array::resize(vm* L, msize_t n) {
@@ -66,6 +83,87 @@ namespace li {
 		}
 	}
 
+	// Push-front, makes room by shifting the elements up if at least half of the storage is free or grows it otherwise,
+	// splitting the free slots evenly between both ends.
+	//
+	void array::push_front(vm* L, any value) {
+		if (head == 0) [[unlikely]] {
+			msize_t c    = slots();
+			msize_t free = c - length;
+			if (free > length) {
+				msize_t gap = (free + 1) / 2;
+				memmove(storage->entries + gap, storage->entries, length * sizeof(any));
+				head = gap;
+			} else {
+				msize_t n = std::max<msize_t>(4, c + (c >> 1) + 1);
+				relocate(L, this, n, (n - length + 1) / 2);
+			}
+		}
+		storage->entries[--head] = value;
+		length++;
+		origin--;
+	}
+
+	// Pop-front.
+	//
+	any array::pop_front() {
+		if (size() == 0) {
+			return nil;
+		}
+		any value = storage->entries[head++];
+		origin++;
+		if (--length == 0) {
+			head = 0;
+		}
+		return value;
+	}
+
+	// Insertion and removal, moves whichever side of the index is shorter when there is room for it.
+	// - Edits at index zero move the origin like the same number of pushes to or pops from the front would, slices
+	//   only see logical indices so the side that is moved in memory does not matter to them.
+	//
+	bool array::insert(vm* L, msize_t idx, const any* values, msize_t n) {
+		if (idx > size()) {
+			return false;
+		}
+		if (!n) {
+			return true;
+		}
+		if (idx < (length / 2) && head >= n) {
+			head -= n;
+			memmove(begin(), begin() + n, idx * sizeof(any));
+		} else {
+			reserve(L, length + n);
+			memmove(begin() + idx + n, begin() + idx, (length - idx) * sizeof(any));
+		}
+		memcpy(begin() + idx, values, n * sizeof(any));
+		length += n;
+		if (idx == 0) {
+			origin -= n;
+		}
+		return true;
+	}
+	bool array::remove(msize_t idx, msize_t n) {
+		if (idx >= size()) {
+			return false;
+		}
+		n = std::min(n, length - idx);
+		if (idx < (length - idx - n)) {
+			memmove(begin() + n, begin(), idx * sizeof(any));
+			head += n;
+		} else {
+			memmove(begin() + idx, begin() + idx + n, (length - idx - n) * sizeof(any));
+		}
+		length -= n;
+		if (idx == 0) {
+			origin += n;
+		}
+		if (length == 0) {
+			head = 0;
+		}
+		return true;
+	}
+
 	// Get/set.
 	// - Set returns false if it should throw because of out-of-boundaries index.
 	//
@@ -8,19 +8,40 @@ namespace li {
 
 		msize_t kval_n = (msize_t) kval.size();
 
+		// Reserve an inline-cache slot per field access, padded so that they are aligned, and a map from the
+		// bytecode position to the slot so that the instructions do not have to carry it.
+		//
+		msize_t icache_n     = (msize_t) std::count_if(opcodes.begin(), opcodes.end(), [](const bc::insn& i) { return bc::is_field_access(i.o); });
+		msize_t icache_pad   = icache_n ? alignof(table_entry*) - 1 : 0;
+		msize_t icache_map_n = icache_n ? routine_length : 0;
+
+		// Reserve a type-profile slot per instruction if the profile can be consumed by the JIT.
+		//
+		msize_t profile_n = 0;
+#if LI_JIT
+		profile_n = routine_length;
+#endif
+
 		// Set function details.
 		//
-		function_proto* result  = L->alloc<function_proto>(sizeof(bc::insn) * routine_length + sizeof(any) * kval_n + sizeof(line_info) * lines.size());
+		function_proto* result  = L->alloc<function_proto>(sizeof(bc::insn) * routine_length + sizeof(any) * kval_n + sizeof(line_info) * lines.size() + icache_pad + sizeof(table_entry*) * icache_n + sizeof(msize_t) * icache_map_n + sizeof(uint16_t) * profile_n);
 		result->num_kval        = kval_n;
 		result->length          = routine_length;
 		result->src_chunk       = string::create(L);
 		result->num_lines       = (msize_t) lines.size();
+		result->num_icache      = icache_n;
+		result->num_icache_map  = icache_map_n;
+		result->num_profile     = profile_n;
 
 		// Copy the information, initialize all upvalues to nil.
 		//
 		std::copy_n(opcodes.data(), opcodes.size(), result->opcode_array);
 		std::copy_n(kval.data(), kval.size(), result->kvals().begin());
 		std::copy_n(lines.data(), lines.size(), result->lines().begin());
+		std::fill_n(result->icache().begin(), icache_n, nullptr);
+		for (msize_t ip = 0, n = 0; ip != icache_map_n; ip++)
+			result->icache_map()[ip] = bc::is_field_access(opcodes[ip].o) ? n++ : 0;
+		std::fill_n(result->type_profile().begin(), profile_n, 0);
 		return result;
 	}
 
@@ -42,10 +63,14 @@ namespace li {
 
 	// GC enumerator.
 	//
+	// - Inline-cache slots are not traversed, they are validated against the table before use.
+	//
 	void gc::traverse(gc::stage_context s, function_proto* o) {
 		o->src_chunk->gc_tick(s);
 		if (o->jfunc)
 			o->jfunc->gc_tick(s);
+		if (o->osr_jfunc)
+			o->osr_jfunc->gc_tick(s);
 		traverse_n(s, o->kvals().data(), o->kvals().size());
 	}
 	void gc::traverse(gc::stage_context s, function* o) {
@@ -33,6 +33,8 @@ namespace li::gc {
 		//
 		if (stage == s || is_static) [[likely]] {
 			return true;
+		} else if (weak) {
+			return false;
 		}
 
 		// Update stage, recurse.
@@ -41,6 +43,8 @@ namespace li::gc {
 		switch (identify_value_type(this)) {
 			case type_table:    traverse(s, (table*) this);          break;
 			case type_array:    traverse(s, (array*) this);          break;
+			case type_omap:     traverse(s, (omap*) this);           break;
+			case type_tarray:   traverse(s, (tarray*) this);         break;
 			case type_object:   traverse(s, (object*) this);         break;
 			case type_class:    traverse(s, (vclass*) this);         break;
 			case type_function: traverse(s, (function*) this);       break;
@@ -255,13 +259,39 @@ namespace li::gc {
 		((header*) L->typeset)->gc_tick(s);
 	}
 
+	static void sweep_weak_tables(vm* L, stage_context s) {
+		// Mark the values of the ephemerons with live keys until there is nothing new, this may revive
+		// other weak tables so dead ones are only skipped for now.
+		//
+		bool changed;
+		do {
+			changed = false;
+			for (table* t = L->gc.weak_tables; t; t = t->weak_next) {
+				if (t->gc_tick(s, true))
+					changed |= t->mark_ephemerons(s);
+			}
+		} while (changed);
+
+		// Unlink the dead tables and remove the dead entries from the rest.
+		//
+		table** prev = &L->gc.weak_tables;
+		while (table* t = *prev) {
+			if (!t->gc_tick(s, true)) {
+				*prev = t->weak_next;
+			} else {
+				t->sweep_weak(s);
+				prev = &t->weak_next;
+			}
+		}
+	}
+
 	void state::close(vm* L) {
 		// Clear stack and globals.
 		//
 		L->stack_top = L->stack;
-		L->modules->mask = 0;
+		L->modules->clear();
 		if (L->repl_scope) {
-			L->repl_scope->mask = 0;
+			L->repl_scope->clear();
 		}
 
 		// GC.
@@ -310,6 +340,7 @@ namespace li::gc {
 		L->stage ^= 1;
 		stage_context ms{bool(L->stage)};
 		traverse_live(L, ms);
+		sweep_weak_tables(L, ms);
 
 		// Free all dead objects.
 		//
@@ -6,20 +6,42 @@
 #include <vm/string.hpp>
 #include <vm/table.hpp>
 #include <vm/object.hpp>
+#include <vm/omap.hpp>
+#include <vm/tarray.hpp>
+#include <lib/std.hpp>
 
 namespace li {
+	// Dispatch helpers, with threaded dispatch each handler ends with its own indirect jump
+	// through the label table instead of branching back to a shared switch. The table has an entry
+	// for every opcode, so the default case is reached through UD alone.
+	//
+#define VM_DECODE() \
+	insn = ip++;    \
+	op   = insn->o; \
+	a    = insn->a; \
+	b    = insn->b; \
+	c    = insn->c;
+#if LI_THREADED_DISPATCH
+	#define VM_CASE(K) LI_STRCAT(vm_op_, K):
+	#define VM_DEFAULT
+	#define VM_DISPATCH()                          \
+		LI_ASSERT(op < std::size(dispatch_table)); \
+		goto* dispatch_table[op];
+	#define VM_NEXT()      \
+		{                  \
+			VM_DECODE();   \
+			VM_DISPATCH(); \
+		}
+#else
+	#define VM_CASE(K) case bc::K:
+	#define VM_DEFAULT default:
+	#define VM_DISPATCH() switch (op)
+	#define VM_NEXT()     continue
+#endif
+
 	// VM helpers.
 	//
-#define VM_RETHROW()                 \
-	{                                 \
-		if (catchpad_i) {              \
-			ip           = catchpad_i;  \
-			L->stack_top = reset_point; \
-			continue;                   \
-		}                              \
-		L->stack_top = locals_begin;   \
-		return exception_marker; \
-	}
+#define VM_RETHROW() goto vm_throw
 #define VM_RET(value, ex)          \
 	{                               \
 		if (ex) [[unlikely]] {       \
@@ -30,46 +52,158 @@ namespace li {
 		return L->ok(value);         \
 	}																					
 
-#define UNOP_HANDLE(K)                    \
-	case K: {                              \
-		auto r = apply_unary(L, REG(b), K); \
-		if (r.is_exc()) [[unlikely]]        \
-			VM_RETHROW();                    \
-		REG(a) = r;                         \
-		continue;                           \
+	// Frame helpers for calls handled within the same activation.
+	// - The caller's exception handler is saved in the call frame, the callee starts without one and leaving
+	//   the callee restores it.
+	// - A callee returning the exception marker is unwound in the caller's frame.
+	//
+#define VM_ENTER(fn, argspace, nargs)                                                   \
+	{                                                                                   \
+		f            = fn;                                                              \
+		args         = argspace;                                                        \
+		n_args       = nargs;                                                           \
+		locals_begin = args + FRAME_SIZE + 1;                                           \
+		reset_point  = L->alloc_stack(f->proto->num_locals) + f->proto->num_locals;     \
+		opcode_array = &f->proto->opcode_array[0];                                      \
+		ip           = opcode_array;                                                    \
+		catchpad_i   = nullptr;                                                         \
+		VM_NEXT();                                                                      \
+	}
+#define VM_LEAVE()                                                                      \
+	{                                                                                   \
+		depth--;                                                                        \
+		auto cf      = li::bit_cast<call_frame>(locals_begin[FRAME_CALLER].value);      \
+		locals_begin = L->stack + cf.stack_pos;                                         \
+		args         = locals_begin - (FRAME_SIZE + 1);                                 \
+		n_args       = depth ? slot_t(cf.caller_nargs) : entry_nargs;                   \
+		f            = locals_begin[FRAME_TARGET].as_fn();                              \
+		opcode_array = &f->proto->opcode_array[0];                                      \
+		ip           = opcode_array + cf.caller_pc + 1;                                 \
+		reset_point  = locals_begin + f->proto->num_locals;                             \
+		catchpad_i   = cf.caller_eh ? opcode_array + cf.caller_eh : nullptr;            \
+		L->stack_top = reset_point;                                                     \
+	}
+#define VM_RETURN(x)                                                                    \
+	{                                                                                   \
+		any retval = x;                                                                 \
+		if (depth) {                                                                    \
+			VM_LEAVE();                                                                 \
+			if (retval.is_exc()) [[unlikely]]                                           \
+				VM_RETHROW();                                                           \
+			REG(ip[-1].a) = retval;                                                     \
+			VM_NEXT();                                                                  \
+		}                                                                               \
+		VM_RET(retval, false);                                                          \
+	}
+
+	// On-stack replacement, once a loop gets hot the rest of the activation continues in the JIT.
+	//
+#define VM_BACKEDGE()                                                                                              \
+	if (auto* jf = vm_profile_loop(L, f, bc::pos(insn - opcode_array), bc::pos(ip - opcode_array))) [[unlikely]] { \
+		L->stack_top = locals_begin;                                                                               \
+		any result   = ((nfunc_t) &jf->code[0])(L, args, n_args);                                                  \
+		if (result.is_exc()) [[unlikely]]                                                                          \
+			VM_RETHROW();                                                                                          \
+		VM_RETURN(result);                                                                                         \
 	}
-#define BINOP_HANDLE(K)                            \
-	case K: {                                       \
-		auto r = apply_binary(L, REG(b), REG(c), K); \
-		if (r.is_exc()) [[unlikely]]                 \
-			VM_RETHROW();                             \
-		REG(a) = r;                                  \
-		continue;                                    \
+
+	// Type feedback for the JIT, marks the types observed by the current instruction while tiering is enabled.
+	//
+#if LI_JIT
+	#define VM_PROFILE(...)                                                   \
+		if (L->jit_threshold)                                                 \
+			f->proto->type_profile()[insn - opcode_array] |= (__VA_ARGS__)
+#else
+	#define VM_PROFILE(...)
+#endif
+
+	// Comparison of two numbers as done by apply_binary, lets the conditional jumps skip it in loops.
+	//
+	template<bc::opcode C>
+	static LI_INLINE bool compare_num(number x, number y) {
+		if constexpr (C == bc::CEQ)
+			return x == y;
+		else if constexpr (C == bc::CLT)
+			return x < y;
+		else
+			return x <= y;
 	}
 
+#define UNOP_HANDLE(K)                        \
+	VM_CASE(K) {                               \
+		auto r = apply_unary(L, REG(b), bc::K); \
+		if (r.is_exc()) [[unlikely]]            \
+			VM_RETHROW();                        \
+		REG(a) = r;                             \
+		VM_NEXT();                              \
+	}
+#define BINOP_HANDLE(K)                                                \
+	VM_CASE(K) {                                                       \
+		VM_PROFILE(type_bit(REG(b).type()) | type_bit(REG(c).type())); \
+		auto r = apply_binary(L, REG(b), REG(c), bc::K);               \
+		if (r.is_exc()) [[unlikely]]                                   \
+			VM_RETHROW();                                              \
+		REG(a) = r;                                                    \
+		VM_NEXT();                                                     \
+	}
+#define JCMP_HANDLE(K, C, V)                                               \
+	VM_CASE(K) {                                                           \
+		VM_PROFILE(type_bit(REG(b).type()) | type_bit(REG(c).type()));     \
+		if (REG(b).is_num() && REG(c).is_num()) [[likely]] {               \
+			if (compare_num<bc::C>(REG(b).as_num(), REG(c).as_num()) == V) \
+				ip += a;                                                   \
+			VM_NEXT();                                                     \
+		}                                                                  \
+		auto r = apply_binary(L, REG(b), REG(c), bc::C);                   \
+		if (r.is_exc()) [[unlikely]]                                       \
+			VM_RETHROW();                                                  \
+		if (r.as_bool() == V)                                              \
+			ip += a;                                                       \
+		VM_NEXT();                                                         \
+	}
+
+	// Bumps the hotness counter of a VM function, promoting it to the JIT once it crosses the
+	// configured threshold. Returns true if the function was promoted.
+	//
+#if LI_JIT
+	static LI_INLINE bool vm_profile(vm* L, function* f) {
+		if (L->jit_threshold && ++f->proto->hotness >= L->jit_threshold && f->invoke == &vm_invoke) [[unlikely]] {
+			return lib::jit_on(L, f, L->jit_verbose);
+		}
+		return false;
+	}
+#else
+	static LI_INLINE bool vm_profile(vm*, function*) { return false; }
+#endif
+
+	// Counts a taken loop back-edge, once the function is hot returns the JIT entry point that continues
+	// execution from the loop header with the current frame. Back-edges that failed to get one are marked
+	// in their profile slot so that they stop asking.
+	//
+#if LI_JIT
+	static LI_INLINE jfunction* vm_profile_loop(vm* L, function* f, bc::pos edge, bc::pos pc) {
+		uint16_t& prof = f->proto->type_profile()[edge];
+		if (L->jit_threshold && !(prof & profile_no_osr) && ++f->proto->hotness >= L->jit_threshold) [[unlikely]] {
+			if (auto* jf = lib::jit_osr(L, f, pc, L->jit_verbose))
+				return jf;
+			prof |= profile_no_osr;
+		}
+		return nullptr;
+	}
+#else
+	static LI_INLINE jfunction* vm_profile_loop(vm*, function*, bc::pos, bc::pos) { return nullptr; }
+#endif
+
 #if !LI_DEBUG
 	#define REG(...)  locals_begin[(__VA_ARGS__)]
 	#define UVAL(...) f->uvals()[(__VA_ARGS__)]
 	#define KVAL(...) f->proto->kvals()[(__VA_ARGS__)]
 #endif
-	any_t LI_CC vm_invoke(vm* L, any* args, slot_t n_args) {
-		LI_ASSERT(&args[2] == &L->stack_top[FRAME_TARGET]);
-		any* const __restrict locals_begin = args + FRAME_SIZE + 1;
-
-		// Validate function.
-		//
-		auto& vf = locals_begin[FRAME_TARGET];
-		if (vf.is_vcl()) {
-			locals_begin[FRAME_SELF] = vf;
-			vf                       = vf.as_vcl()->ctor;
-		}
-		if (!vf.is_fn()) [[unlikely]] {
-			return L->error("invoking non-function");
-		}
-		function* f = vf.as_fn();
-		if (f->invoke != &vm_invoke) {
-			return f->invoke(L, args, n_args);
-		}
+	// Interpreter loop, runs the function whose frame starts at args from the given bytecode position.
+	//
+	static any_t vm_run(vm* L, function* f, any* args, slot_t n_args, bc::pos start) {
+		any* __restrict locals_begin = args + FRAME_SIZE + 1;
+		any* entry_locals            = locals_begin;
 
 		// Allocate stack space.
 		//
@@ -95,42 +229,53 @@ namespace li {
 			LI_ASSERT(f->proto->num_kval > (msize_t) r);
 			return f->proto->kvals()[r];
 		};
+#endif
+#if LI_THREADED_DISPATCH
+		static const void* const dispatch_table[] = {
+	#define BC_WRITE(name, a, b, c) &&LI_STRCAT(vm_op_, name),
+			 LIGHTNING_ENUM_BC(BC_WRITE)
+	#undef BC_WRITE
+		};
 #endif
 		const bc::insn* __restrict catchpad_i = nullptr;
 		const auto* __restrict opcode_array = &f->proto->opcode_array[0];
-		const auto* __restrict ip           = opcode_array;
+		const auto* __restrict ip           = opcode_array + start;
+		msize_t                    depth       = 0;       // Number of VM frames entered by this invocation.
+		slot_t                     entry_nargs = n_args;  // Number of arguments of the frame at depth zero.
+		const bc::insn* __restrict insn;
+		bc::opcode                 op;
+		bc::reg                    a, b, c;
 		while (true) {
-			const auto& __restrict insn = *ip++;
-			auto [op, a, b, c]          = insn;
-			switch (op) {
-				UNOP_HANDLE(bc::TOBOOL)
-				UNOP_HANDLE(bc::LNOT)
-				UNOP_HANDLE(bc::ANEG)
-				BINOP_HANDLE(bc::AADD)
-				BINOP_HANDLE(bc::ASUB)
-				BINOP_HANDLE(bc::AMUL)
-				BINOP_HANDLE(bc::ADIV)
-				BINOP_HANDLE(bc::AMOD)
-				BINOP_HANDLE(bc::APOW)
-				BINOP_HANDLE(bc::LAND)
-				BINOP_HANDLE(bc::NCS)
-				BINOP_HANDLE(bc::LOR)
-				BINOP_HANDLE(bc::CEQ)
-				BINOP_HANDLE(bc::CNE)
-				BINOP_HANDLE(bc::CLT)
-				BINOP_HANDLE(bc::CGT)
-				BINOP_HANDLE(bc::CLE)
-				BINOP_HANDLE(bc::CGE)
-
-				case bc::CCAT: {
+			VM_DECODE();
+			VM_DISPATCH() {
+				UNOP_HANDLE(TOBOOL)
+				UNOP_HANDLE(LNOT)
+				UNOP_HANDLE(ANEG)
+				BINOP_HANDLE(AADD)
+				BINOP_HANDLE(ASUB)
+				BINOP_HANDLE(AMUL)
+				BINOP_HANDLE(ADIV)
+				BINOP_HANDLE(AMOD)
+				BINOP_HANDLE(APOW)
+				BINOP_HANDLE(LAND)
+				BINOP_HANDLE(NCS)
+				BINOP_HANDLE(LOR)
+				BINOP_HANDLE(CEQ)
+				BINOP_HANDLE(CNE)
+				BINOP_HANDLE(CLT)
+				BINOP_HANDLE(CGT)
+				BINOP_HANDLE(CLE)
+				BINOP_HANDLE(CGE)
+
+				VM_CASE(CCAT) {
 					REG(a) = string::concat(L, &REG(a), b);
-					continue;
+					VM_NEXT();
 				}
-				case bc::CTY: {
+				VM_CASE(CTY) {
 					REG(a) = REG(b).type() == c;
-					continue;
+					VM_NEXT();
 				}
-				case bc::CTYX: {
+				VM_CASE(CTYX) {
 					auto* cl = REG(c).as_vcl();
 					bool  is_instance = false;
 					if (auto o = REG(b); o.is_obj()) {
@@ -142,28 +287,57 @@ namespace li {
 						}
 					}
 					REG(a) = is_instance;
-					continue;
+					VM_NEXT();
 				}
-				case bc::MOV: {
+				VM_CASE(MOV) {
 					REG(a) = REG(b);
-					continue;
+					VM_NEXT();
 				}
-				case bc::RET:
-					VM_RET(REG(a), false);
-				case bc::JNS:
+				VM_CASE(RET) {
+					VM_RETURN(REG(a));
+				}
+				VM_CASE(JNS)
 					if (REG(b).coerce_bool())
-						continue;
+						VM_NEXT();
 					ip += a;
-					continue;
-				case bc::JS:
+					VM_NEXT();
+				VM_CASE(JS)
 					if (!REG(b).coerce_bool())
-						continue;
+						VM_NEXT();
 					ip += a;
-					continue;
-				case bc::JMP:
+					VM_NEXT();
+				JCMP_HANDLE(JEQ, CEQ, true)
+				JCMP_HANDLE(JNE, CEQ, false)
+				JCMP_HANDLE(JLT, CLT, true)
+				JCMP_HANDLE(JLE, CLE, true)
+				JCMP_HANDLE(JNLT, CLT, false)
+				JCMP_HANDLE(JNLE, CLE, false)
+				VM_CASE(FORPREP) {
+					auto r = apply_binary(L, REG(b), REG(b + 1), c ? bc::CLE : bc::CLT);
+					if (r.is_exc()) [[unlikely]]
+						VM_RETHROW();
+					LI_ASSERT(REG(b + 2).is_num());
+					if (!r.as_bool())
+						ip += a;
+					VM_NEXT();
+				}
+				VM_CASE(FORLOOP) {
+					auto&  it  = REG(b);
+					number x   = it.as_num() + REG(b + 2).as_num();
+					number max = REG(b + 1).as_num();
+					it         = any(x);
+					if (c ? x <= max : x < max) {
+						ip += a;
+						VM_BACKEDGE();
+					}
+					VM_NEXT();
+				}
+				VM_CASE(JMP)
 					ip += a;
-					continue;
-				case bc::ITER: {
+					if (a < 0)
+						VM_BACKEDGE();
+					VM_NEXT();
+				VM_CASE(ITER) {
 					auto  target = REG(c);
 					auto& iter   = REG(b + 0);
 					auto& k      = REG(b + 1);
@@ -225,24 +399,66 @@ namespace li {
 						// Table:
 						//
 						case type_table: {
-							table* t = target.as_tbl();
-							auto*  e = t->begin();
-							for (; it < (t->size() + overflow_factor); it++) {
-								if (e[it].key != nil) {
+							// Array part first, then the hash part.
+							//
+							table* t   = target.as_tbl();
+							auto   arr = t->array_part();
+							for (; it < arr.size(); it++) {
+								if (arr[it] != nil) {
+									k          = any(number(it));
+									v          = arr[it];
+									iter.value = uint32_t(it + 1);
+									ok         = true;
+									break;
+								}
+							}
+							if (ok)
+								break;
+
+							// Then the hash part, followed by the previous one during an incremental rehash.
+							//
+							msize_t base = msize_t(arr.size());
+							for (std::span<table_entry> part : {std::span{t->begin(), t->end()}, t->old_part()}) {
+								if (msize_t i = table::next_slot(part, it - base); i != part.size()) {
 									// Write the pair.
 									//
-									k = e[it].key;
-									v = e[it].value;
+									k = part[i].key;
+									v = part[i].value;
 
 									// Update the iterator.
 									//
-									iter.value = uint32_t(it + 1);
+									iter.value = uint32_t(base + i + 1);
 
 									// Break.
 									//
 									ok = true;
 									break;
 								}
+								base += msize_t(part.size());
+								it = std::max(it, base);
+							}
+							break;
+						}
+
+						// Typed array:
+						//
+						case type_tarray: {
+							tarray* t = target.as_tarr();
+							if (it < t->available()) {
+								k          = any(number(it));
+								v          = t->get(L, it);
+								iter.value = uint32_t(it + 1);
+								ok         = true;
+							}
+							break;
+						}
+
+						// Ordered map:
+						//
+						case type_omap: {
+							if (target.as_omap()->at(it, k, v)) {
+								iter.value = uint32_t(it + 1);
+								ok         = true;
 							}
 							break;
 						}
@@ -262,35 +478,50 @@ namespace li {
 					if (!ok) {
 						ip += a;
 					}
-					continue;
+					VM_NEXT();
 				}
-				case bc::KIMM: {
-					REG(a) = any(std::in_place, insn.xmm());
-					continue;
+				VM_CASE(KIMM) {
+					REG(a) = any(std::in_place, insn->xmm());
+					VM_NEXT();
 				}
-				case bc::UGET: {
+				VM_CASE(UGET) {
 					REG(a) = UVAL(b);
-					continue;
+					VM_NEXT();
 				}
-				case bc::USET: {
+				VM_CASE(USET) {
 					UVAL(a) = REG(b);
-					continue;
+					VM_NEXT();
 				}
-				case bc::TGET:
-				case bc::TGETR: {
+				VM_CASE(TGET)
+				VM_CASE(TGETR) {
 					auto tbl = REG(c);
 					auto key = REG(b);
+					VM_PROFILE(type_bit(tbl.type()));
 					if (key == nil) [[unlikely]] {
 						VM_RET(string::create(L, "indexing with null key"), true);
 					}
 
 					if (tbl.is_tbl()) {
-						REG(a) = tbl.as_tbl()->get(L, REG(b));
+						auto* t = tbl.as_tbl();
+						if (key.is_str()) {
+							auto& ic = f->proto->icache_at(bc::pos(insn - opcode_array));
+							if (!t->owns(ic) || ic->key != key) [[unlikely]] {
+								ic = t->find_entry(key);
+							}
+							REG(a) = ic ? ic->value : any(nil);
+						} else {
+							REG(a) = t->get(L, key);
+						}
 					} else if (tbl.is_arr()) {
 						if (!key.is_num() || key.as_num() < 0) [[unlikely]] {
 							VM_RET(string::create(L, "indexing array with non-integer or negative key"), true);
 						}
 						REG(a) = tbl.as_arr()->get(L, msize_t(key.as_num()));
+					} else if (tbl.is_tarr()) {
+						if (!key.is_num() || key.as_num() < 0) [[unlikely]] {
+							VM_RET(string::create(L, "indexing array with non-integer or negative key"), true);
+						}
+						REG(a) = tbl.as_tarr()->get(L, msize_t(key.as_num()));
 					} else if (tbl.is_str()) {
 						if (!key.is_num() || key.as_num() < 0) [[unlikely]] {
 							VM_RET(string::create(L, "indexing string with non-integer or negative key"), true);
@@ -304,23 +535,36 @@ namespace li {
 							val = tbl.as_obj()->get(key.as_str());
 						}
 						REG(a) = val;
+					} else if (tbl.is_omap()) {
+						REG(a) = tbl.as_omap()->get(key);
 					} else {
 						VM_RET(string::create(L, "indexing non-table"), true);
 					}
-					continue;
+					VM_NEXT();
 				}
-				case bc::TSET:
-				case bc::TSETR: {
+				VM_CASE(TSET)
+				VM_CASE(TSETR) {
 					auto tbl = REG(c);
 					auto key = REG(a);
 					auto val = REG(b);
+					VM_PROFILE(type_bit(tbl.type()));
 
 					if (key == nil) [[unlikely]] {
 						VM_RET(string::create(L, "indexing with null key"), true);
 					}
 
 					if (tbl.is_tbl()) {
-						tbl.as_tbl()->set(L, key, val);
+						auto* t = tbl.as_tbl();
+						if (key.is_str() && val != nil) {
+							auto& ic = f->proto->icache_at(bc::pos(insn - opcode_array));
+							if (t->owns(ic) && ic->key == key) [[likely]] {
+								ic->value = val;
+								VM_NEXT();
+							}
+							ic = t->set(L, key, val);
+						} else {
+							t->set(L, key, val);
+						}
 						L->gc.tick(L);
 					} else if (tbl.is_arr()) {
 						if (!key.is_num() || key.as_num() < 0) [[unlikely]] {
@@ -329,6 +573,16 @@ namespace li {
 						if (!tbl.as_arr()->set(L, msize_t(key.as_num()), val)) [[unlikely]] {
 							VM_RET(string::create(L, "out-of-boundaries array access"), true);
 						}
+					} else if (tbl.is_tarr()) {
+						if (!key.is_num() || key.as_num() < 0) [[unlikely]] {
+							VM_RET(string::create(L, "indexing array with non-integer or negative key"), true);
+						}
+						if (!tbl.as_tarr()->accepts(val)) [[unlikely]] {
+							VM_RET(string::create(L, "storing non-number or out-of-range value into typed array"), true);
+						}
+						if (!tbl.as_tarr()->set(L, msize_t(key.as_num()), val)) [[unlikely]] {
+							VM_RET(string::create(L, "out-of-boundaries array access"), true);
+						}
 					} else if (tbl.is_obj()) {
 						if (!key.is_str()) [[unlikely]] {
 							VM_RET(string::create(L, "indexing class instance with non-string key"), true);
@@ -336,18 +590,44 @@ namespace li {
 						if (!tbl.as_obj()->set(L, key.as_str(), val)) {
 							VM_RETHROW();
 						}
+					} else if (tbl.is_omap()) {
+						if (!tbl.as_omap()->set(L, key, val)) [[unlikely]] {
+							VM_RET(string::create(L, "modifying an ordered map range"), true);
+						}
+						L->gc.tick(L);
 					} else [[unlikely]] {
 						VM_RET(string::create(L, "indexing non-table"), true);
 					}
-					continue;
+					VM_NEXT();
 				}
 
-				case bc::STRIV: {
+				// Globals live in the slots of their scope table, writes go through to the entry mirroring the
+				// slot if it is still current and through table::set otherwise, which updates the slot.
+				//
+				VM_CASE(GGET) {
+					REG(a) = KVAL(c).as_tbl()->globals->entries[b].value;
+					VM_NEXT();
+				}
+				VM_CASE(GSET) {
+					auto* t   = KVAL(c).as_tbl();
+					auto& g   = t->globals->entries[a];
+					auto  val = REG(b);
+					if (val != nil && t->owns(g.entry) && g.entry->key == g.key) [[likely]] {
+						g.entry->value = val;
+						g.value        = val;
+						VM_NEXT();
+					}
+					t->set(L, g.key, val);
 					L->gc.tick(L);
-					REG(a) = object::create(L, any_t{insn.xmm()}.as_vcl());
-					continue;
+					VM_NEXT();
 				}
-				case bc::SSET: {
+
+				VM_CASE(STRIV) {
+					L->gc.tick(L);
+					REG(a) = object::create(L, any_t{insn->xmm()}.as_vcl());
+					VM_NEXT();
+				}
+				VM_CASE(SSET) {
 					auto tbl = REG(c);
 					auto key = REG(a);
 					auto val = REG(b);
@@ -357,9 +637,9 @@ namespace li {
 					if (!tbl.as_obj()->set(L, key.as_str(), val)) {
 						VM_RETHROW();
 					}
-					continue;
+					VM_NEXT();
 				}
-				case bc::SGET: {
+				VM_CASE(SGET) {
 					auto tbl = REG(c);
 					auto key = REG(b);
 					any val = nil;
@@ -367,36 +647,43 @@ namespace li {
 						val = tbl.as_obj()->get(key.as_str());
 					}
 					REG(a) = val;
-					continue;
+					VM_NEXT();
 				}
 
-				case bc::VACHK: {
+				VM_CASE(VACHK) {
 					if (n_args < a) [[unlikely]] {
-						VM_RET(any(any_t{insn.xmm()}), true);
+						VM_RET(any(any_t{insn->xmm()}), true);
 					}
-					continue;
+					VM_NEXT();
 				}
-				case bc::VACNT: {
+				VM_CASE(VACNT) {
 					REG(a) = number(n_args);
-					continue;
+					VM_NEXT();
 				}
-				case bc::VAGET: {
+				VM_CASE(VAGET) {
 					auto idx = msize_t(REG(b).as_num());
 					REG(a)   = n_args > idx ? args[-(int32_t)idx] : nil;
-					continue;
+					VM_NEXT();
 				}
 
-				case bc::ANEW: {
+				VM_CASE(ANEW) {
 					L->gc.tick(L);
 					REG(a) = any{array::create(L, b)};
-					continue;
+					VM_NEXT();
 				}
-				case bc::TNEW: {
+				VM_CASE(TNEW) {
 					L->gc.tick(L);
 					REG(a) = any{table::create(L, b)};
-					continue;
+					VM_NEXT();
+				}
+				VM_CASE(TDUP) {
+					L->gc.tick(L);
+					auto tbl = KVAL(b);
+					LI_ASSERT(tbl.is_tbl());
+					REG(a) = any{tbl.as_tbl()->duplicate(L)};
+					VM_NEXT();
 				}
-				case bc::FDUP: {
+				VM_CASE(FDUP) {
 					L->gc.tick(L);
 					auto fn = KVAL(b);
 					LI_ASSERT(fn.is_fn());
@@ -406,52 +693,155 @@ namespace li {
 						r->uvals()[i] = REG(c + i);
 					}
 					REG(a) = r;
-					continue;
+					VM_NEXT();
 				}
-				case bc::SETEH: {
+				VM_CASE(SETEH) {
 					if (a) {
 						catchpad_i = ip + a;
 					} else {
 						catchpad_i = nullptr;
 					}
-					continue;
+					VM_NEXT();
 				}
-				case bc::SETEX: {
+				VM_CASE(SETEX) {
 					L->last_ex = REG(a);
-					continue;
+					VM_NEXT();
 				}
-				case bc::GETEX: {
+				VM_CASE(GETEX) {
 					REG(a) = L->last_ex;
-					continue;
+					VM_NEXT();
 				}
-				case bc::CALL: {
-					call_frame cf{.caller_pc = msize_t(ip - 1 - opcode_array), .stack_pos = msize_t(locals_begin - L->stack)};
-					auto       argspace = L->stack_top - 3;
-				
+				VM_CASE(CALL) {
+					call_frame cf{
+						 .caller_pc    = msize_t(ip - 1 - opcode_array),
+						 .stack_pos    = msize_t(locals_begin - L->stack),
+						 .caller_eh    = catchpad_i ? msize_t(catchpad_i - opcode_array) : 0,
+						 .caller_nargs = depth ? msize_t(n_args) : 0,
+					};
+					auto argspace = L->stack_top - 3;
 					L->push_stack(any(std::in_place, li::bit_cast<uint64_t>(cf)));
+
+					// Resolve the target, if it is a VM function enter it without recursing.
+					//
+					auto& vf = argspace[2];
+					VM_PROFILE(type_bit(vf.type()));
+					if (vf.is_vcl()) {
+						argspace[1] = vf;
+						vf          = vf.as_vcl()->ctor;
+					}
+					if (vf.is_fn() && vf.as_fn()->invoke == &vm_invoke && !vm_profile(L, vf.as_fn())) {
+						if (depth++ == 0)
+							entry_nargs = n_args;
+						VM_ENTER(vf.as_fn(), argspace, b);
+					}
 					any result = vm_invoke(L, argspace, b);
 					if (result.is_exc()) [[unlikely]] {
 						VM_RETHROW();
 					}
 					REG(a)       = result;
 					L->stack_top = reset_point;
-					continue;
+					VM_NEXT();
 				}
-				case bc::PUSHR:
+				VM_CASE(TCALL) {
+					// Move the callee, self and the arguments over the current frame, keeping our caller's record.
+					//
+					auto cf   = locals_begin[FRAME_CALLER];
+					auto base = args + 1 - n_args;
+					auto src  = L->stack_top - (b + 2);
+					std::copy(src, L->stack_top, base);
+					base[b + 2]  = cf;
+					L->stack_top = base + b + 3;
+					if (depth == 0) {
+						entry_locals = L->stack_top;
+					}
+					auto argspace = L->stack_top - (FRAME_SIZE + 1);
+
+					// Resolve the target, enter it in place if it is a VM function.
+					//
+					auto& vf = argspace[2];
+					VM_PROFILE(type_bit(vf.type()));
+					if (vf.is_vcl()) {
+						argspace[1] = vf;
+						vf          = vf.as_vcl()->ctor;
+					}
+					catchpad_i = nullptr;
+					if (vf.is_fn() && vf.as_fn()->invoke == &vm_invoke && !vm_profile(L, vf.as_fn())) {
+						VM_ENTER(vf.as_fn(), argspace, b);
+					}
+
+					// Otherwise invoke it and return the result.
+					//
+					locals_begin = argspace + FRAME_SIZE + 1;
+					any result   = vm_invoke(L, argspace, b);
+					if (result.is_exc()) [[unlikely]] {
+						VM_RETHROW();
+					}
+					VM_RETURN(result);
+				}
+				VM_CASE(PUSHR)
 					L->push_stack(REG(a));
-					continue;
-				case bc::PUSHI:
-					L->push_stack(any_t{insn.xmm()});
-					continue;
-				case bc::NOP:
-					continue;
-				default:
+					VM_NEXT();
+				VM_CASE(PUSHI)
+					L->push_stack(any_t{insn->xmm()});
+					VM_NEXT();
+				VM_CASE(NOP)
+					VM_NEXT();
+				VM_CASE(UD)
+				VM_DEFAULT
 #if LI_DEBUG
 					util::abort("unrecognized opcode '%02x'", (msize_t) op);
 #else
 					assume_unreachable();
 #endif
 			}
+
+			// Exception handling, leaves the frames entered in place until one has a handler armed or
+			// returns the exception from this invocation.
+			//
+		vm_throw:
+			while (!catchpad_i && depth) {
+				VM_LEAVE();
+			}
+			if (catchpad_i) {
+				ip           = catchpad_i;
+				L->stack_top = reset_point;
+				VM_NEXT();
+			}
+			L->stack_top = entry_locals;
+			return exception_marker;
+		}
+	}
+
+	any_t LI_CC vm_invoke(vm* L, any* args, slot_t n_args) {
+		LI_ASSERT(&args[2] == &L->stack_top[FRAME_TARGET]);
+
+		// Validate function.
+		//
+		auto& vf = args[2];
+		if (vf.is_vcl()) {
+			args[1] = vf;
+			vf      = vf.as_vcl()->ctor;
 		}
+		if (!vf.is_fn()) [[unlikely]] {
+			return L->error("invoking non-function");
+		}
+		function* f = vf.as_fn();
+		if (f->invoke != &vm_invoke || vm_profile(L, f)) {
+			return f->invoke(L, args, n_args);
+		}
+		return vm_run(L, f, args, n_args, 0);
+	}
+	any_t LI_CC vm_deopt(vm* L, any* args, slot_t n_args, msize_t pc) {
+		function* f = args[2].as_fn();
+#if LI_JIT
+		// Stop entering the JIT code if its speculations keep failing.
+		//
+		if (++f->proto->num_deopt == LI_JIT_DEOPT_LIMIT) {
+			f->proto->attr |= func_attr_no_jit;
+			f->invoke = &vm_invoke;
+		}
+#endif
+		L->stack_top = args + FRAME_SIZE + 1;
+		return vm_run(L, f, args, n_args, pc);
 	}
 };
\ No newline at end of file
@@ -0,0 +1,363 @@
+#include <vm/omap.hpp>
+#include <vm/string.hpp>
+#include <cmath>
+
+namespace li {
+	omap* omap::create(vm* L) {
+		omap* m = L->alloc<omap>();
+		m->root = L->alloc<omap_leaf>();
+		return m;
+	}
+
+	// Key ordering.
+	//
+	bool omap::less(any_t a, any_t b) {
+		if (a.is_num() && b.is_num()) {
+			number x = a.as_num();
+			number y = b.as_num();
+			return x < y || (std::isnan(y) && !std::isnan(x));
+		}
+		if (a.is_str() && b.is_str()) {
+			return a.as_str() != b.as_str() && a.as_str()->view() < b.as_str()->view();
+		}
+		if (a.type() != b.type()) {
+			return a.type() < b.type();
+		}
+		return a.value < b.value;
+	}
+
+	// Node helpers.
+	//
+	static msize_t lower_index(const any* keys, msize_t count, any_t key) {
+		msize_t lo = 0, hi = count;
+		while (lo < hi) {
+			msize_t mid = (lo + hi) / 2;
+			if (omap::less(keys[mid], key))
+				lo = mid + 1;
+			else
+				hi = mid;
+		}
+		return lo;
+	}
+	static msize_t child_index(const omap_inner* n, any_t key) {
+		msize_t lo = 1, hi = n->count;
+		while (lo < hi) {
+			msize_t mid = (lo + hi) / 2;
+			if (omap::less(key, n->keys[mid]))
+				hi = mid;
+			else
+				lo = mid + 1;
+		}
+		return lo - 1;
+	}
+	static msize_t node_count(gc::header* n, msize_t height) { return height ? ((omap_inner*) n)->count : ((omap_leaf*) n)->count; }
+	static any_t   node_min(gc::header* n, msize_t height) { return height ? ((omap_inner*) n)->keys[0] : ((omap_leaf*) n)->keys[0]; }
+	static msize_t node_size(gc::header* n, msize_t height) {
+		if (!height)
+			return ((omap_leaf*) n)->count;
+		auto*   in = (omap_inner*) n;
+		msize_t r  = 0;
+		for (msize_t i = 0; i != in->count; i++)
+			r += in->sizes[i];
+		return r;
+	}
+
+	// GC details.
+	//
+	static void traverse_node(gc::stage_context s, gc::header* node, msize_t height) {
+		node->gc_tick(s);
+		if (!height) {
+			auto* n = (omap_leaf*) node;
+			gc::traverse_n(s, n->keys, n->count);
+			gc::traverse_n(s, n->values, n->count);
+		} else {
+			// Lower bounds may be keys that were removed since, they are still compared against.
+			//
+			auto* n = (omap_inner*) node;
+			gc::traverse_n(s, n->keys, n->count);
+			for (msize_t i = 0; i != n->count; i++)
+				traverse_node(s, n->children[i], height - 1);
+		}
+	}
+	void gc::traverse(gc::stage_context s, omap* o) {
+		if (o->parent) {
+			o->parent->gc_tick(s);
+			gc::traverse_n(s, &o->lo, 2);
+		} else {
+			traverse_node(s, o->root, o->height);
+		}
+	}
+
+	// Insertion, returns the new right sibling if the node had to be split.
+	//
+	static gc::header* insert(vm* L, gc::header* node, msize_t height, any_t key, any_t value, bool& added) {
+		constexpr msize_t half = omap_order / 2;
+		if (!height) {
+			auto*   n = (omap_leaf*) node;
+			msize_t i = lower_index(n->keys, n->count, key);
+			if (i != n->count && !omap::less(key, n->keys[i])) {
+				n->values[i] = value;
+				return nullptr;
+			}
+			added = true;
+
+			// Split a full leaf in half and insert into the side the key belongs to.
+			//
+			omap_leaf* r = nullptr;
+			if (n->count == omap_order) {
+				r = L->alloc<omap_leaf>();
+				std::copy_n(n->keys + half, half, r->keys);
+				std::copy_n(n->values + half, half, r->values);
+				r->count = half;
+				n->count = half;
+				if (i > half) {
+					n = r;
+					i -= half;
+				}
+			}
+			std::copy_backward(n->keys + i, n->keys + n->count, n->keys + n->count + 1);
+			std::copy_backward(n->values + i, n->values + n->count, n->values + n->count + 1);
+			n->keys[i]   = key;
+			n->values[i] = value;
+			n->count++;
+			return r;
+		}
+
+		auto*   n = (omap_inner*) node;
+		msize_t c = child_index(n, key);
+		if (omap::less(key, n->keys[c]))
+			n->keys[c] = key;
+		gc::header* split = insert(L, n->children[c], height - 1, key, value, added);
+		n->sizes[c] += added;
+		if (!split)
+			return nullptr;
+
+		// Link the new sibling right after the child, splitting this node as well if it is full.
+		//
+		msize_t moved = node_size(split, height - 1);
+		n->sizes[c] -= moved;
+
+		omap_inner* r = nullptr;
+		msize_t     i = c + 1;
+		if (n->count == omap_order) {
+			r = L->alloc<omap_inner>();
+			std::copy_n(n->keys + half, half, r->keys);
+			std::copy_n(n->sizes + half, half, r->sizes);
+			std::copy_n(n->children + half, half, r->children);
+			r->count = half;
+			n->count = half;
+			if (i > half) {
+				n = r;
+				i -= half;
+			}
+		}
+		std::copy_backward(n->keys + i, n->keys + n->count, n->keys + n->count + 1);
+		std::copy_backward(n->sizes + i, n->sizes + n->count, n->sizes + n->count + 1);
+		std::copy_backward(n->children + i, n->children + n->count, n->children + n->count + 1);
+		n->keys[i]     = node_min(split, height - 1);
+		n->sizes[i]    = moved;
+		n->children[i] = split;
+		n->count++;
+		return r;
+	}
+
+	// Removal, returns false if the key was not found.
+	//
+	static void merge_nodes(gc::header* left, gc::header* right, msize_t height) {
+		if (!height) {
+			auto* l = (omap_leaf*) left;
+			auto* r = (omap_leaf*) right;
+			std::copy_n(r->keys, r->count, l->keys + l->count);
+			std::copy_n(r->values, r->count, l->values + l->count);
+			l->count += r->count;
+		} else {
+			auto* l = (omap_inner*) left;
+			auto* r = (omap_inner*) right;
+			std::copy_n(r->keys, r->count, l->keys + l->count);
+			std::copy_n(r->sizes, r->count, l->sizes + l->count);
+			std::copy_n(r->children, r->count, l->children + l->count);
+			l->count += r->count;
+		}
+	}
+	static bool erase(vm* L, gc::header* node, msize_t height, any_t key) {
+		if (!height) {
+			auto*   n = (omap_leaf*) node;
+			msize_t i = lower_index(n->keys, n->count, key);
+			if (i == n->count || omap::less(key, n->keys[i]))
+				return false;
+			std::copy(n->keys + i + 1, n->keys + n->count, n->keys + i);
+			std::copy(n->values + i + 1, n->values + n->count, n->values + i);
+			n->count--;
+			return true;
+		}
+
+		auto*   n = (omap_inner*) node;
+		msize_t c = child_index(n, key);
+		if (!erase(L, n->children[c], height - 1, key))
+			return false;
+		n->sizes[c]--;
+
+		// Merge the child into a neighbour once it gets sparse, empty children are always merged away.
+		//
+		if (n->count > 1 && node_count(n->children[c], height - 1) < omap_order / 4) {
+			msize_t l = c == n->count - 1 ? c - 1 : c;
+			if (node_count(n->children[l], height - 1) + node_count(n->children[l + 1], height - 1) <= omap_order) {
+				merge_nodes(n->children[l], n->children[l + 1], height - 1);
+				L->gc.free(L, n->children[l + 1]);
+				n->sizes[l] += n->sizes[l + 1];
+				std::copy(n->keys + l + 2, n->keys + n->count, n->keys + l + 1);
+				std::copy(n->sizes + l + 2, n->sizes + n->count, n->sizes + l + 1);
+				std::copy(n->children + l + 2, n->children + n->count, n->children + l + 1);
+				n->count--;
+			}
+		}
+		return true;
+	}
+
+	// Map get/set.
+	//
+	bool omap::set(vm* L, any_t key, any_t value) {
+		if (parent)
+			return false;
+
+		if (value == nil) {
+			if (erase(L, root, height, key)) {
+				length--;
+				while (height && ((omap_inner*) root)->count == 1) {
+					auto* prev = root;
+					root       = ((omap_inner*) root)->children[0];
+					height--;
+					L->gc.free(L, prev);
+				}
+			}
+			return true;
+		}
+
+		bool added = false;
+		if (auto* split = insert(L, root, height, key, value, added)) {
+			auto* r        = L->alloc<omap_inner>();
+			r->count       = 2;
+			r->keys[0]     = node_min(root, height);
+			r->sizes[0]    = node_size(root, height);
+			r->children[0] = root;
+			r->keys[1]     = node_min(split, height);
+			r->sizes[1]    = node_size(split, height);
+			r->children[1] = split;
+			root           = r;
+			height++;
+		}
+		length += added;
+		return true;
+	}
+	any_t omap::get(any_t key) {
+		if (parent) {
+			if ((lo != nil && less(key, lo)) || (hi != nil && !less(key, hi)))
+				return nil;
+			return parent->get(key);
+		}
+
+		gc::header* node = root;
+		for (msize_t h = height; h; h--) {
+			auto* n = (omap_inner*) node;
+			node    = n->children[child_index(n, key)];
+		}
+		auto*   n = (omap_leaf*) node;
+		msize_t i = lower_index(n->keys, n->count, key);
+		if (i == n->count || less(key, n->keys[i]))
+			return nil;
+		return n->values[i];
+	}
+
+	// Rank queries.
+	//
+	static msize_t tree_lower_bound(omap* m, any_t key) {
+		msize_t     rank = 0;
+		gc::header* node = m->root;
+		for (msize_t h = m->height; h; h--) {
+			auto*   n = (omap_inner*) node;
+			msize_t c = child_index(n, key);
+			for (msize_t i = 0; i != c; i++)
+				rank += n->sizes[i];
+			node = n->children[c];
+		}
+		auto* n = (omap_leaf*) node;
+		return rank + lower_index(n->keys, n->count, key);
+	}
+	static msize_t view_begin(omap* m) { return m->lo == nil ? 0 : tree_lower_bound(m->parent, m->lo); }
+	static msize_t view_end(omap* m) { return m->hi == nil ? m->parent->length : tree_lower_bound(m->parent, m->hi); }
+
+	msize_t omap::lower_bound(any_t key) {
+		if (!parent)
+			return tree_lower_bound(this, key);
+		msize_t b = view_begin(this);
+		msize_t e = view_end(this);
+		return std::clamp(tree_lower_bound(parent, key), b, std::max(b, e)) - b;
+	}
+	bool omap::at(msize_t rank, any& key, any& value) {
+		if (parent) {
+			msize_t b = view_begin(this);
+			if (b + rank >= view_end(this))
+				return false;
+			return parent->at(b + rank, key, value);
+		}
+
+		if (rank >= length)
+			return false;
+		gc::header* node = root;
+		for (msize_t h = height; h; h--) {
+			auto*   n = (omap_inner*) node;
+			msize_t c = 0;
+			while (rank >= n->sizes[c])
+				rank -= n->sizes[c++];
+			node = n->children[c];
+		}
+		auto* n = (omap_leaf*) node;
+		key     = n->keys[rank];
+		value   = n->values[rank];
+		return true;
+	}
+	msize_t omap::size() {
+		if (!parent)
+			return length;
+		msize_t b = view_begin(this);
+		msize_t e = view_end(this);
+		return e > b ? e - b : 0;
+	}
+
+	// Views and duplication.
+	//
+	omap* omap::range(vm* L, any_t from, any_t to) {
+		omap* base = parent ? parent : this;
+		if (parent) {
+			if (from == nil || (lo != nil && less(from, lo)))
+				from = lo;
+			if (to == nil || (hi != nil && less(hi, to)))
+				to = hi;
+		}
+		omap* v   = L->alloc<omap>();
+		v->parent = base;
+		v->lo     = from;
+		v->hi     = to;
+		return v;
+	}
+	static gc::header* copy_node(vm* L, gc::header* node, msize_t height) {
+		if (!height)
+			return L->duplicate((const omap_leaf*) node);
+		auto* n = L->duplicate((const omap_inner*) node);
+		for (msize_t i = 0; i != n->count; i++)
+			n->children[i] = copy_node(L, n->children[i], height - 1);
+		return n;
+	}
+	omap* omap::duplicate(vm* L) {
+		if (parent) {
+			omap* r = create(L);
+			any   k, v;
+			for (msize_t i = 0; at(i, k, v); i++)
+				r->set(L, k, v);
+			return r;
+		}
+		omap* r = L->duplicate(this);
+		r->root = copy_node(L, root, height);
+		return r;
+	}
+};
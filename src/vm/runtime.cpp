@@ -2,6 +2,8 @@
 #include <vm/array.hpp>
 #include <vm/table.hpp>
 #include <vm/string.hpp>
+#include <vm/omap.hpp>
+#include <vm/tarray.hpp>
 
 namespace li::runtime {
 	// v--- Completely wrong.
@@ -21,6 +23,20 @@ namespace li::runtime {
 			if (!tbl.as_arr()->set(L, msize_t(key.as_num()), val)) {
 				return any(string::create(L, "out-of-boundaries array access"));
 			}
+		} else if (tbl.is_tarr()) {
+			if (!key.is_num() || key.as_num() < 0) [[unlikely]] {
+				return any(string::create(L, "indexing array with non-integer or negative key"));
+			}
+			if (!tbl.as_tarr()->accepts(val)) [[unlikely]] {
+				return any(string::create(L, "storing non-number or out-of-range value into typed array"));
+			}
+			if (!tbl.as_tarr()->set(L, msize_t(key.as_num()), val)) {
+				return any(string::create(L, "out-of-boundaries array access"));
+			}
+		} else if (tbl.is_omap()) {
+			if (!tbl.as_omap()->set(L, key, val)) {
+				return any(string::create(L, "modifying an ordered map range"));
+			}
 		} else [[unlikely]] {
 			return any(string::create(L, "indexing non-table"));
 		}
@@ -38,6 +54,11 @@ namespace li::runtime {
 				util::abort("indexing array with non-integer or negative key");
 			}
 			return tbl.as_arr()->get(L, msize_t(key.as_num()));
+		} else if (tbl.is_tarr()) {
+			if (!key.is_num() || key.as_num() < 0) [[unlikely]] {
+				util::abort("indexing array with non-integer or negative key");
+			}
+			return tbl.as_tarr()->get(L, msize_t(key.as_num()));
 		} else if (tbl.is_str()) {
 			if (!key.is_num() || key.as_num() < 0) [[unlikely]] {
 				util::abort("indexing string with non-integer or negative key");
@@ -45,6 +66,8 @@ namespace li::runtime {
 			auto i = size_t(key.as_num());
 			auto v = tbl.as_str()->view();
 			return v.size() <= i ? nil : any(number((uint8_t) v[i]));
+		} else if (tbl.is_omap()) {
+			return tbl.as_omap()->get(key);
 		} else {
 			util::abort("indexing non-table");
 		}
@@ -33,6 +33,7 @@ namespace li {
 		typeset_init(L);
 		lib::detail::register_builtin(L);
 		lib::detail::register_math(L);
+		util::freeze_modules(L);
 		return L;
 	}
 
@@ -1,108 +1,663 @@
 #include <vm/table.hpp>
+#include <array>
 #include <bit>
+#include <vector>
 #include <vm/string.hpp>
+#if LI_HAS_SSE2
+	#include <emmintrin.h>
+#endif
 
 namespace li {
+	// Control byte group matching, each returns a bitmask of the matching slots in the group.
+	//
+#if LI_HAS_SSE2
+	static uint32_t group_match(const int8_t* g, int8_t h2) {
+		__m128i ctrl = _mm_loadu_si128((const __m128i*) g);
+		return (uint32_t) _mm_movemask_epi8(_mm_cmpeq_epi8(ctrl, _mm_set1_epi8(h2)));
+	}
+	static uint32_t group_match_free(const int8_t* g) {
+		__m128i ctrl = _mm_loadu_si128((const __m128i*) g);
+		return (uint32_t) _mm_movemask_epi8(_mm_cmplt_epi8(ctrl, _mm_set1_epi8(ctrl_sentinel)));
+	}
+	static uint32_t group_match_full(const int8_t* g) {
+		__m128i ctrl = _mm_loadu_si128((const __m128i*) g);
+		return ~(uint32_t) _mm_movemask_epi8(ctrl) & 0xFFFF;
+	}
+#else
+	static uint32_t group_match(const int8_t* g, int8_t h2) {
+		uint32_t r = 0;
+		for (msize_t i = 0; i != group_width; i++)
+			r |= uint32_t(g[i] == h2) << i;
+		return r;
+	}
+	static uint32_t group_match_free(const int8_t* g) {
+		uint32_t r = 0;
+		for (msize_t i = 0; i != group_width; i++)
+			r |= uint32_t(g[i] < ctrl_sentinel) << i;
+		return r;
+	}
+	static uint32_t group_match_full(const int8_t* g) {
+		uint32_t r = 0;
+		for (msize_t i = 0; i != group_width; i++)
+			r |= uint32_t(g[i] >= 0) << i;
+		return r;
+	}
+#endif
+	static uint32_t group_match_empty(const int8_t* g) { return group_match(g, ctrl_empty); }
+
+	// Hash split, h1 selects the first group to probe and h2 is stored in the control byte.
+	//
+	static size_t hash_h1(size_t hash) { return hash >> 7; }
+	static int8_t hash_h2(size_t hash) { return int8_t(hash & 0x7F); }
+
+	// Allocates a node list with every slot empty, slots past the capacity in the first group are
+	// sentinels so that they never match.
+	//
+	static table_nodes* alloc_nodes(vm* L, msize_t capacity) {
+		msize_t      ctrl_length = std::max(capacity, group_width);
+		table_nodes* nl          = L->alloc<table_nodes>(sizeof(table_entry) * capacity + ctrl_length);
+		fill_nil(nl->entries, 2 * capacity);
+		auto* ctrl = (int8_t*) &nl->entries[capacity];
+		memset(ctrl, ctrl_empty, capacity);
+		memset(ctrl + capacity, ctrl_sentinel, ctrl_length - capacity);
+		return nl;
+	}
+
+	// Occupancy scan over the control bytes, skipping a whole group of empty or deleted slots at once.
+	//
+	msize_t table::next_slot(std::span<table_entry> part, msize_t i) {
+		auto*   ctrl = (const int8_t*) (part.data() + part.size());
+		msize_t n    = msize_t(part.size());
+		while (i < n) {
+			msize_t g = i & ~(group_width - 1);
+			if (uint32_t m = group_match_full(ctrl + g) >> (i - g))
+				return i + std::countr_zero(m);
+			i = g + group_width;
+		}
+		return n;
+	}
+	template<typename F>
+	static void for_each_live(std::span<table_entry> part, F&& f) {
+		for (msize_t i = table::next_slot(part, 0); i != part.size(); i = table::next_slot(part, i + 1))
+			f(part[i]);
+	}
+	static msize_t count_live(std::span<table_entry> part) {
+		auto*   ctrl = (const int8_t*) (part.data() + part.size());
+		msize_t n    = 0;
+		for (msize_t g = 0; g < part.size(); g += group_width)
+			n += std::popcount(group_match_full(ctrl + g));
+		return n;
+	}
+	static std::span<table_entry> hash_part(table* t) { return {t->begin(), t->end()}; }
+
 	table* table::create(vm* L, msize_t rsvd) {
-		rsvd                      = std::bit_ceil(rsvd | 2);
-		size_t       alloc_length = sizeof(table_entry) * (rsvd + overflow_factor);
-		table*       tbl          = L->alloc<table>();
-		table_nodes* nl           = L->alloc<table_nodes>(alloc_length);
-		tbl->mask                 = compute_mask(rsvd);
-		tbl->node_list            = nl;
-		fill_nil(nl->entries, alloc_length / sizeof(any));
+		msize_t cap      = capacity_for(rsvd);
+		table*  tbl      = L->alloc<table>();
+		tbl->node_list   = alloc_nodes(L, cap);
+		tbl->capacity    = cap;
+		tbl->growth_left = max_load(cap);
 		return tbl;
 	}
 
 	// GC details.
 	//
+	static bool is_weak_ref(any_t v) { return v.is_gc() && !v.is_str(); }
+	static bool is_alive(any_t v, gc::stage_context s) { return !v.is_gc() || v.as_gc()->gc_tick(s, true); }
+
+	static void traverse_weak(gc::stage_context s, table* o, std::span<table_entry> part) {
+		for_each_live(part, [&](table_entry& e) {
+			auto& [k, v]  = e;
+			bool weak_key = o->weak_keys && is_weak_ref(k);
+			if (k.is_gc() && !weak_key)
+				k.as_gc()->gc_tick(s);
+
+			// Values of weak keys are marked by the ephemeron pass once the key is known to be alive.
+			//
+			if (v.is_gc() && !weak_key && !(o->weak_values && is_weak_ref(v)))
+				v.as_gc()->gc_tick(s);
+		});
+	}
 	void gc::traverse(gc::stage_context s, table* o) {
 		o->node_list->gc_tick(s);
-		traverse_n(s, (any*) o->begin(), 2 * o->realsize());
+		if (o->old_list)
+			o->old_list->gc_tick(s);
+		if (o->array_list)
+			o->array_list->gc_tick(s);
+
+		// Slot values are always strong, which also keeps the entries mirroring them in weak tables alive.
+		//
+		if (o->globals) [[unlikely]] {
+			o->globals->gc_tick(s);
+			o->globals->index->gc_tick(s);
+			for (auto& g : std::span{o->globals->entries, o->globals->count})
+				traverse_n(s, &g.key, 2);
+		}
+
+		if (o->weak_keys || o->weak_values) [[unlikely]] {
+			traverse_weak(s, o, hash_part(o));
+			traverse_weak(s, o, o->old_part());
+			for (auto& v : o->array_part()) {
+				if (v.is_gc() && !(o->weak_values && is_weak_ref(v)))
+					v.as_gc()->gc_tick(s);
+			}
+			return;
+		}
+
+		for (auto part : {hash_part(o), o->old_part()}) {
+			for_each_live(part, [&](table_entry& e) { traverse_n(s, &e.key, 2); });
+		}
+		if (o->array_list)
+			traverse_n(s, o->array_list->entries, o->array_size);
 	}
 
 	// Joins another table into this.
 	//
 	void table::join(vm* L, table* other) {
-		for (auto& [k, v] : *other) {
-			if (k != nil)
-				set(L, k, v);
+		auto arr = other->array_part();
+		for (msize_t i = 0; i != arr.size(); i++) {
+			if (arr[i] != nil)
+				set(L, any(number(i)), arr[i]);
+		}
+		for (auto part : {hash_part(other), other->old_part()}) {
+			for_each_live(part, [&](table_entry& e) { set(L, e.key, e.value); });
 		}
 	}
 
+	// Probing helpers, the group sequence is triangular which visits every group once since the
+	// group count is a power of two.
+	//
+	static msize_t home_group(msize_t capacity, size_t hash) {
+		msize_t gmask = capacity <= group_width ? 0 : (capacity / group_width) - 1;
+		return msize_t(hash_h1(hash)) & gmask;
+	}
+	template<typename F>
+	static void probe(table_nodes* nl, msize_t capacity, size_t hash, F&& f) {
+		auto*   ctrl  = (int8_t*) &nl->entries[capacity];
+		msize_t gmask = capacity <= group_width ? 0 : (capacity / group_width) - 1;
+		msize_t g     = home_group(capacity, hash);
+		for (msize_t step = 1; !f(nl->entries + g * group_width, ctrl + g * group_width); step++) {
+			g = (g + step) & gmask;
+		}
+	}
+	template<typename F>
+	static void probe(table* t, size_t hash, F&& f) {
+		probe(t->node_list, t->capacity, hash, std::forward<F>(f));
+	}
+	static table_entry* find_free_slot(table* t, size_t hash) {
+		table_entry* result = nullptr;
+		probe(t, hash, [&](table_entry* entries, const int8_t* ctrl) {
+			if (uint32_t m = group_match_free(ctrl)) {
+				result = entries + std::countr_zero(m);
+				return true;
+			}
+			return false;
+		});
+		return result;
+	}
+
+	// Inserts a key known not to be in the table into the first free slot.
+	//
+	static table_entry* insert_slot(table* t, any_t key, any_t value) {
+		size_t hash = key.hash();
+		auto*  e    = find_free_slot(t, hash);
+		auto&  c    = t->ctrl()[e - t->begin()];
+		t->growth_left -= c == ctrl_empty;
+		*e = {key, value};
+		c  = hash_h2(hash);
+		return e;
+	}
+
+	// Removes the entry at the given slot, the slot can be marked empty if its group still has an
+	// empty slot since no probe would have continued past it.
+	//
+	static void erase_slot(table* t, table_entry* e) {
+		// Entries still in the previous hash part are only ever read by the migration.
+		//
+		if (!t->owns(e)) {
+			auto    old  = t->old_part();
+			int8_t* ctrl = (int8_t*) (old.data() + old.size());
+			*e           = {nil, nil};
+			ctrl[e - old.data()] = ctrl_deleted;
+			return;
+		}
+
+		msize_t idx  = msize_t(e - t->begin());
+		int8_t* ctrl = t->ctrl();
+		*e           = {nil, nil};
+		if (group_match_empty(ctrl + (idx & ~(group_width - 1)))) {
+			ctrl[idx] = ctrl_empty;
+			t->growth_left++;
+		} else {
+			ctrl[idx] = ctrl_deleted;
+		}
+	}
+
+	// Returns the hash entry holding the key or nullptr if there is none.
+	//
+	static table_entry* find_in(table_nodes* nl, msize_t capacity, any_t key) {
+		size_t       hash   = key.hash();
+		int8_t       h2     = hash_h2(hash);
+		table_entry* result = nullptr;
+		probe(nl, capacity, hash, [&](table_entry* entries, const int8_t* ctrl) {
+			for (uint32_t m = group_match(ctrl, h2); m; m &= m - 1) {
+				if (entries[std::countr_zero(m)].key == key) {
+					result = &entries[std::countr_zero(m)];
+					return true;
+				}
+			}
+
+			// The key cannot be past a group with an empty slot.
+			//
+			return group_match_empty(ctrl) != 0;
+		});
+		return result;
+	}
+	// Perfect layouts only have to check the home group, where at most one control byte can match.
+	//
+	static table_entry* find_perfect(table* t, any_t key) {
+		size_t  hash = key.hash();
+		msize_t base = home_group(t->size(), hash) * group_width;
+		if (uint32_t m = group_match(t->ctrl() + base, hash_h2(hash))) {
+			auto* e = t->begin() + base + std::countr_zero(m);
+			if (e->key == key)
+				return e;
+		}
+		return nullptr;
+	}
+	table_entry* table::find_entry(any_t key) {
+		if (is_perfect)
+			return find_perfect(this, key);
+
+		table_entry* result = find_in(node_list, capacity, key);
+		if (!result && old_list) [[unlikely]]
+			result = find_in(old_list, old_capacity, key);
+		return result;
+	}
+
 	// Rehashing resize.
 	//
 	void table::resize(vm* L, msize_t n) {
-		msize_t new_count = std::bit_ceil(n);
-		msize_t old_count = size();
-		if (new_count > old_count) {
-			auto*  old_list     = node_list;
-			auto*  old_entries  = begin();
-			size_t alloc_length = sizeof(table_entry) * (new_count + overflow_factor);
-			auto*  new_list     = L->alloc<table_nodes>(alloc_length);
-			mask                = compute_mask(new_count);
-			node_list           = new_list;
-			fill_nil(new_list->entries, alloc_length / sizeof(any));
-
-			if (old_list) {
-				for (msize_t i = 0; i != (old_count + overflow_factor); i++) {
-					if (old_entries[i].key != nil) {
-						set(L, old_entries[i].key, old_entries[i].value);
-					}
-				}
-				L->gc.free(L, old_list);
+		msize_t new_count = capacity_for(n);
+		if (new_count > size()) {
+			migrate(L);
+
+			// Move the dense integer keys out of the hash part first.
+			//
+			if (msize_t n = optimal_array_size(); n > array_size) {
+				resize_array(L, n);
 			}
+			rehash(L, new_count, true);
 		}
 	}
+	void table::rehash(vm* L, msize_t new_count, bool incremental) {
+		migrate(L);
 
-	// Raw table get/set.
+		// Large hash parts keep the previous list around and move it over on the next insertions, the new
+		// list fills slower than the migration finishes so the moved entries always find a free slot.
+		//
+		if (incremental && size() >= incremental_rehash_min) {
+			old_list     = node_list;
+			old_capacity = capacity;
+			migrate_pos  = 0;
+			node_list    = alloc_nodes(L, new_count);
+			capacity     = new_count;
+			growth_left  = max_load(new_count);
+			needs_shrink = false;
+			is_perfect   = false;
+			return;
+		}
+
+		is_perfect      = false;
+		auto* prev_list = node_list;
+		auto  prev_part = hash_part(this);
+		node_list       = alloc_nodes(L, new_count);
+		capacity        = new_count;
+		growth_left     = max_load(new_count);
+		needs_shrink    = false;
+
+		for_each_live(prev_part, [&](table_entry& e) { insert_slot(this, e.key, e.value); });
+		L->gc.free(L, prev_list);
+	}
+	void table::migrate(vm* L, msize_t n) {
+		if (!old_list)
+			return;
+
+		// Moved slots are cleared so that lookups and iteration only ever see one copy of an entry.
+		//
+		auto    old  = old_part();
+		auto*   ctrl = (int8_t*) (old.data() + old.size());
+		msize_t end  = std::min(old_capacity, migrate_pos + std::min(n, old_capacity));
+		for (migrate_pos = next_slot(old, migrate_pos); migrate_pos < end; migrate_pos = next_slot(old, migrate_pos + 1)) {
+			auto& e = old[migrate_pos];
+			insert_slot(this, e.key, e.value);
+			e                 = {nil, nil};
+			ctrl[migrate_pos] = ctrl_deleted;
+		}
+		migrate_pos = std::max(migrate_pos, end);
+		if (migrate_pos == old_capacity) {
+			L->gc.free(L, old_list);
+			old_list     = nullptr;
+			old_capacity = 0;
+			migrate_pos  = 0;
+		}
+	}
+
+	// Shrinks both parts to fit the current entries.
 	//
-	void table::set(vm* L, any_t key, any_t value) {
-		size_t hash = key.hash();
-		if (value != nil) [[likely]] {
-			msize_t      next_count   = active_count + 1;
-			table_entry* suitable_kv = nullptr;
-			for (auto& entry : find(hash)) {
-				if (entry.key == key) {
-					suitable_kv = &entry;
-					next_count--;
+	void table::compact(vm* L) {
+		migrate(L);
+
+		// Shrink the array part if it is no longer dense, the tail is moved to the hash part.
+		//
+		msize_t arr_count = optimal_array_size();
+		auto*   old_array = array_list;
+		msize_t old_size  = array_size;
+		if (arr_count < old_size) {
+			array_list = nullptr;
+			array_size = 0;
+			if (arr_count) {
+				array_list = L->alloc<table_array>(sizeof(any) * arr_count);
+				memcpy(array_list->entries, old_array->entries, sizeof(any) * arr_count);
+				array_size = arr_count;
+			}
+		}
+
+		// Rehash the hash part to the smallest capacity that fits the live entries and the array tail.
+		//
+		msize_t live = count_live(hash_part(this));
+		for (msize_t i = array_size; i < old_size; i++)
+			live += old_array->entries[i] != nil;
+		rehash(L, capacity_for(live));
+
+		if (old_array != array_list) {
+			for (msize_t i = array_size; i < old_size; i++) {
+				if (old_array->entries[i] != nil)
+					insert_slot(this, any(number(i)), old_array->entries[i]);
+			}
+			L->gc.free(L, old_array);
+		}
+	}
+
+	// Freezes the table and picks a collision-free layout for the hash part if possible.
+	//
+	void table::freeze(vm* L) {
+		is_frozen = true;
+		compact(L);
+
+		// Find the smallest capacity where no home group holds more keys than it has slots and no two of
+		// them share a control byte, giving up past a few doublings.
+		//
+		msize_t min_capacity = size();
+		for (msize_t cap = min_capacity; cap <= 8 * min_capacity; cap <<= 1) {
+			msize_t                             group_count = std::max<msize_t>(cap / group_width, 1);
+			std::vector<std::array<uint64_t, 2>> used(group_count);
+			std::vector<msize_t>                 count(group_count);
+
+			bool ok = true;
+			for (auto& [k, v] : *this) {
+				if (k == nil)
+					continue;
+				size_t  hash = k.hash();
+				msize_t g    = home_group(cap, hash);
+				int8_t  h2   = hash_h2(hash);
+				auto&   bits = used[g][h2 >> 6];
+				if (((bits >> (h2 & 63)) & 1) || ++count[g] > std::min(cap, group_width)) {
+					ok = false;
 					break;
-				} else if (entry.key == nil) {
-					suitable_kv = &entry;
 				}
+				bits |= 1ull << (h2 & 63);
 			}
-			if (suitable_kv) [[likely]] {
-				*suitable_kv = {key, value};
-				active_count  = next_count;
+			if (ok) {
+				if (cap != size())
+					rehash(L, cap);
+				is_perfect = true;
 				return;
 			}
+		}
+	}
+
+	// Array part resize.
+	//
+	void table::resize_array(vm* L, msize_t n) {
+		msize_t old_count = array_size;
+		if (n <= old_count)
+			return;
+
+		migrate(L);
+
+		auto* prev_list = array_list;
+		auto* new_list  = L->alloc<table_array>(sizeof(any) * n);
+		if (prev_list) {
+			memcpy(new_list->entries, prev_list->entries, sizeof(any) * old_count);
+			L->gc.free(L, prev_list);
+		}
+		fill_nil(new_list->entries + old_count, n - old_count);
+		array_list = new_list;
+		array_size = n;
 
-			while (true) {
-				resize(L, size() << 1);
-				for (auto& entry : find(hash)) {
-					if (entry.key == nil) {
-						entry        = {key, value};
-						active_count = next_count;
-						return;
-					}
+		for_each_live(hash_part(this), [&](table_entry& e) {
+			if (auto* slot = find_array(e.key)) {
+				*slot = e.value;
+				erase_slot(this, &e);
+			}
+		});
+	}
+	msize_t table::optimal_array_size() {
+		// Count the integer keys by their bit width.
+		//
+		msize_t nums[33] = {};
+		msize_t total    = 0;
+		auto    arr      = array_part();
+		for (msize_t i = 0; i != arr.size(); i++) {
+			if (arr[i] != nil) {
+				nums[std::bit_width(i)]++;
+				total++;
+			}
+		}
+		for (auto& [k, v] : *this) {
+			if (k.is_num()) {
+				number n = k.as_num();
+				if (0 <= n && n < number(1u << 31) && msize_t(n) == n) {
+					nums[std::bit_width(msize_t(n))]++;
+					total++;
 				}
 			}
-		} else {
-			for (auto& entry : find(hash)) {
-				if (entry.key == key) {
-					entry = {nil, nil};
+		}
+
+		// Pick the largest power of two that would be more than half full.
+		//
+		msize_t result = 0;
+		msize_t acc    = 0;
+		for (msize_t b = 0; b != 32 && (1u << b) < 2 * total; b++) {
+			acc += nums[b];
+			if (acc > ((1u << b) >> 1))
+				result = 1u << b;
+		}
+		return result < min_array_size ? 0 : result;
+	}
+
+	// Clears all entries.
+	//
+	void table::clear() {
+		fill_nil(begin(), 2 * size());
+		memset(ctrl(), ctrl_empty, size());
+		growth_left  = max_load(size());
+		active_count = 0;
+		array_size   = 0;
+		old_list     = nullptr;
+		old_capacity = 0;
+		migrate_pos  = 0;
+		if (globals) {
+			for (auto& g : std::span{globals->entries, globals->count}) {
+				g.value = nil;
+				g.entry = nullptr;
+			}
+		}
+	}
+
+	// Global slots.
+	//
+	msize_t table::add_global(vm* L, string* name) {
+		any key{name};
+		if (!globals) {
+			globals           = L->alloc<table_globals>(sizeof(table_global) * min_table_size);
+			globals->index    = table::create(L);
+			globals->capacity = min_table_size;
+		} else if (auto* e = globals->index->find_entry(key)) {
+			return msize_t(e->value.as_num());
+		}
+
+		if (globals->count == globals->capacity) {
+			auto* nl     = L->alloc<table_globals>(sizeof(table_global) * globals->capacity * 2);
+			nl->index    = globals->index;
+			nl->count    = globals->count;
+			nl->capacity = globals->capacity * 2;
+			std::copy_n(globals->entries, globals->count, nl->entries);
+			L->gc.free(L, std::exchange(globals, nl));
+		}
+
+		msize_t slot           = globals->count++;
+		auto*   e              = find_entry(key);
+		globals->entries[slot] = {key, e ? e->value : any(nil), e};
+		globals->index->set(L, key, any(number(slot)));
+		return slot;
+	}
+
+	// Weak table details.
+	//
+	void table::set_weak(vm* L, bool keys, bool values) {
+		if (!weak_keys && !weak_values && (keys || values))
+			weak_next = std::exchange(L->gc.weak_tables, this);
+		weak_keys   = keys;
+		weak_values = values;
+	}
+	bool table::mark_ephemerons(gc::stage_context s) {
+		if (!weak_keys || weak_values)
+			return false;
+
+		bool changed = false;
+		for (auto part : {hash_part(this), old_part()}) {
+			for_each_live(part, [&](table_entry& e) {
+				if (is_weak_ref(e.key) && e.value.is_gc() && is_alive(e.key, s) && !is_alive(e.value, s)) {
+					e.value.as_gc()->gc_tick(s);
+					changed = true;
+				}
+			});
+		}
+		return changed;
+	}
+	void table::sweep_weak(gc::stage_context s) {
+		auto is_dead = [&](any_t k, any_t v) {
+			return (weak_keys && is_weak_ref(k) && !is_alive(k, s)) || (weak_values && is_weak_ref(v) && !is_alive(v, s));
+		};
+		for (auto part : {hash_part(this), old_part()}) {
+			for_each_live(part, [&](table_entry& e) {
+				if (is_dead(e.key, e.value)) {
+					erase_slot(this, &e);
 					active_count--;
-					break;
 				}
+			});
+		}
+		for (auto& v : array_part()) {
+			if (v != nil && is_dead(nil, v)) {
+				v = nil;
+				active_count--;
 			}
 		}
 	}
-	any_t table::get(vm* L, any_t key) {
-		any value = {};
-		for (auto& entry : find(key.hash())) {
-			if (entry.key == key)
-				value = entry.value;
+
+	// Raw table get/set.
+	//
+	table_entry* table::set(vm* L, any_t key, any_t value) {
+		table_entry* e = set_entry(L, key, value);
+		if (globals) [[unlikely]] {
+			if (key.is_str()) {
+				if (auto* s = globals->index->find_entry(key)) {
+					auto& g = globals->entries[msize_t(s->value.as_num())];
+					g.value = value;
+					g.entry = e;
+				}
+			}
+
+			// Not handed out so that field caches never write past the slots.
+			//
+			return nullptr;
+		}
+		return e;
+	}
+	table_entry* table::set_entry(vm* L, any_t key, any_t value) {
+		if (auto* slot = find_array(key)) {
+			if (*slot == nil)
+				active_count += value != nil;
+			else
+				active_count -= value == nil;
+			*slot = value;
+			return nullptr;
+		}
+
+		// Update or remove the existing entry.
+		//
+		if (auto* e = find_entry(key)) {
+			if (value == nil) {
+				erase_slot(this, e);
+				active_count--;
+
+				// Shrink on the next insertion once the occupancy drops low enough, doing so here would
+				// reorder the slots under an iteration clearing the table.
+				//
+				if (active_count < (size() / 8) && size() > min_table_size)
+					needs_shrink = true;
+				return nullptr;
+			}
+			e->value = value;
+			return e;
+		}
+		if (value == nil) {
+			return nullptr;
+		}
+
+		// Appending right after a full array part grows it instead.
+		//
+		if (key.is_num() && key.as_num() == array_size && (!array_size || array_list->entries[array_size - 1] != nil)) {
+			resize_array(L, std::max(min_array_size, array_size * 2));
+			return set_entry(L, key, value);
+		}
+
+		// Shrink after a mass deletion.
+		//
+		if (needs_shrink) [[unlikely]] {
+			if (active_count < (size() / 8))
+				rehash(L, capacity_for(2 * active_count + 1));
+			needs_shrink = false;
+		}
+
+		// Continue any incremental rehash.
+		//
+		if (old_list) [[unlikely]] {
+			migrate(L, incremental_rehash_step);
 		}
-		return value;
+
+		// Insert into the first free slot, reusing deleted slots does not consume any growth.
+		//
+		if (!growth_left) [[unlikely]] {
+			// Drop the deleted slots in place if at most half of the load is live, grow otherwise.
+			//
+			migrate(L);
+			msize_t live = count_live(hash_part(this));
+			if (live <= max_load(size()) / 2)
+				rehash(L, size(), true);
+			else
+				resize(L, max_load(size()) + 1);
+			return set_entry(L, key, value);
+		}
+		active_count++;
+		is_perfect = false;
+		return insert_slot(this, key, value);
+	}
+	any_t table::get(vm* L, any_t key) {
+		if (auto* slot = find_array(key))
+			return *slot;
+		auto* e = find_entry(key);
+		return e ? e->value : any(nil);
 	}
-};
\ No newline at end of file
+};
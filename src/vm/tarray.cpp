@@ -0,0 +1,228 @@
+#include <vm/tarray.hpp>
+#include <vm/string.hpp>
+
+namespace li {
+	tarray* tarray::create(vm* L, li::type elem, msize_t length, msize_t rsvd) {
+		tarray* arr  = L->alloc<tarray>();
+		arr->elem    = elem;
+		arr->storage = L->alloc<array_store>(std::bit_ceil(length + rsvd) * arr->stride());
+		arr->resize(L, length);
+		return arr;
+	}
+	tarray* tarray::slice(vm* L, any_t src, msize_t begin, msize_t end) {
+		gc::header* parent;
+		li::type    elem;
+		msize_t     offset = 0;
+		msize_t     length;
+		if (src.is_arr()) {
+			parent = src.as_arr();
+			elem   = type::any;
+			offset = src.as_arr()->origin;
+			length = src.as_arr()->size();
+		} else if (src.is_tarr()) {
+			auto* t = src.as_tarr();
+			parent  = t->parent ? t->parent : t;
+			elem    = t->elem;
+			offset  = t->offset;
+			length  = t->available();
+		} else {
+			return nullptr;
+		}
+
+		end   = std::min(end, length);
+		begin = std::min(begin, end);
+
+		tarray* arr = L->alloc<tarray>();
+		arr->elem   = elem;
+		arr->parent = parent;
+		arr->offset = offset + begin;
+		arr->length = end - begin;
+		return arr;
+	}
+	bool tarray::parse_type(any_t name, li::type& out) {
+		if (!name.is_str())
+			return false;
+		static constexpr std::pair<std::string_view, li::type> types[] = {
+			 {"f64", type::f64},
+			 {"f32", type::f32},
+			 {"i64", type::i64},
+			 {"i32", type::i32},
+			 {"i16", type::i16},
+			 {"i8", type::i8},
+		};
+		for (auto& [k, v] : types) {
+			if (name.as_str()->view() == k) {
+				out = v;
+				return true;
+			}
+		}
+		return false;
+	}
+
+	// GC enumerator.
+	//
+	void gc::traverse(gc::stage_context s, tarray* o) {
+		if (o->storage)
+			o->storage->gc_tick(s);
+		if (o->parent)
+			o->parent->gc_tick(s);
+		else if (o->elem == type::any)
+			traverse_n(s, (any*) o->data(), o->size());
+	}
+
+	// Element access.
+	//
+	uint8_t* tarray::data() {
+		if (!parent)
+			return storage ? (uint8_t*) storage->entries : nullptr;
+		if (gc::identify_value_type(parent) == type_array) {
+			auto* a = (array*) parent;
+			return (uint8_t*) (a->begin() + msize_t(offset - a->origin));
+		}
+		return ((tarray*) parent)->data() + offset * stride();
+	}
+	msize_t tarray::available() const {
+		if (!parent)
+			return length;
+		if (gc::identify_value_type(parent) == type_array) {
+			// Offsets count from the origin so pushing to or popping from the front does not move the window, the
+			// elements popped from the front wrap around to an index past the end.
+			//
+			auto*   a   = (array*) parent;
+			msize_t idx = offset - a->origin;
+			return a->size() > idx ? std::min(length, a->size() - idx) : 0;
+		}
+		msize_t n = ((tarray*) parent)->size();
+		return n > offset ? std::min(length, n - offset) : 0;
+	}
+	static any load_element(tarray* t, msize_t idx) {
+		auto* p = t->data() + idx * t->stride();
+		return t->elem == type::any ? *(any*) p : any::load_from(p, t->elem);
+	}
+	static void store_element(tarray* t, msize_t idx, any value) {
+		auto* p = t->data() + idx * t->stride();
+		if (t->elem == type::any)
+			*(any*) p = value;
+		else
+			value.store_at(p, t->elem);
+	}
+
+	// Copies borrowed elements into storage owned by the array, elements past the end of the parent are dropped.
+	//
+	void tarray::own(vm* L) {
+		if (!parent)
+			return;
+		msize_t n    = available();
+		auto*   src  = data();
+		auto*   list = L->alloc<array_store>(std::bit_ceil(n) * stride());
+		memcpy(list->entries, src, n * stride());
+		storage = list;
+		parent  = nullptr;
+		offset  = 0;
+		length  = n;
+	}
+
+	// Duplicates the array.
+	//
+	tarray* tarray::duplicate(vm* L) {
+		tarray* r = L->duplicate(this);
+		if (parent) {
+			r->storage = nullptr;
+			r->own(L);
+		} else {
+			r->storage = L->duplicate(r->storage);
+		}
+		return r;
+	}
+
+	// Reserve and resize.
+	//
+	void tarray::reserve(vm* L, msize_t n) {
+		own(L);
+		if (!storage) {
+			storage = L->alloc<array_store>(n * stride());
+		} else if (msize_t c = capacity(); n > c) {
+			msize_t new_capacity = std::max(n, c + (c >> 1));
+			auto*   old_list     = storage;
+			storage              = L->alloc<array_store>(stride() * new_capacity);
+			memcpy(storage->entries, old_list->entries, length * stride());
+			L->gc.free(L, old_list);
+		}
+	}
+	void tarray::resize(vm* L, msize_t n) {
+		own(L);
+		msize_t old_count = size();
+		if (n > old_count) {
+			reserve(L, n);
+			if (elem == type::any)
+				fill_nil((any*) data() + old_count, n - old_count);
+			else
+				memset(data() + old_count * stride(), 0, (n - old_count) * stride());
+		}
+		length = n;
+	}
+
+	// Push-back.
+	//
+	void tarray::push(vm* L, any value) {
+		own(L);
+		if (size() == capacity()) [[unlikely]] {
+			reserve(L, size() + 1);
+		}
+		store_element(this, length++, value);
+	}
+
+	// Pop-back.
+	//
+	any tarray::pop(vm* L) {
+		own(L);
+		if (size() != 0) {
+			return load_element(this, --length);
+		} else {
+			return nil;
+		}
+	}
+
+	// Insertion and removal.
+	//
+	bool tarray::insert(vm* L, msize_t idx, const any* values, msize_t n) {
+		own(L);
+		if (idx > size()) {
+			return false;
+		}
+		reserve(L, length + n);
+		memmove(data() + (idx + n) * stride(), data() + idx * stride(), (length - idx) * stride());
+		for (msize_t i = 0; i != n; i++)
+			store_element(this, idx + i, values[i]);
+		length += n;
+		return true;
+	}
+	bool tarray::remove(vm* L, msize_t idx, msize_t n) {
+		own(L);
+		if (idx >= size()) {
+			return false;
+		}
+		n = std::min(n, length - idx);
+		memmove(data() + idx * stride(), data() + (idx + n) * stride(), (length - idx - n) * stride());
+		length -= n;
+		return true;
+	}
+
+	// Get/set.
+	// - Set returns false if it should throw because of out-of-boundaries index.
+	//
+	bool tarray::set(vm* L, msize_t idx, any value) {
+		if (idx < available()) {
+			own(L);
+			store_element(this, idx, value);
+			return true;
+		}
+		return false;
+	}
+	any tarray::get(vm*, msize_t idx) {
+		if (idx < available())
+			return load_element(this, idx);
+		else
+			return nil;
+	}
+};
@@ -1,5 +1,7 @@
 #include <vm/types.hpp>
 #include <vm/table.hpp>
+#include <vm/omap.hpp>
+#include <vm/tarray.hpp>
 #include <vm/array.hpp>
 #include <vm/object.hpp>
 #include <vm/string.hpp>
@@ -60,6 +62,12 @@ namespace li {
 			case type_table:
 				formatter("table @ %p", a.as_gc());
 				break;
+			case type_omap:
+				formatter("omap @ %p", a.as_gc());
+				break;
+			case type_tarray:
+				formatter("tarray @ %p", a.as_gc());
+				break;
 			case type_string:
 				formatter("\"%s\"", a.as_str()->data);
 				break;
@@ -153,6 +161,10 @@ namespace li {
 			return any(as_obj()->duplicate(L));
 		} else if (is_fn()) {
 			return any(as_fn()->duplicate(L));
+		} else if (is_omap()) {
+			return any(as_omap()->duplicate(L));
+		} else if (is_tarr()) {
+			return any(as_tarr()->duplicate(L));
 		} else {
 			return *this;
 		}
@@ -217,6 +229,10 @@ namespace li {
 				return *(string* const*) data;
 			case type::vcl:
 				return *(vclass* const*) data;
+			case type::omap:
+				return *(omap* const*) data;
+			case type::tarr:
+				return *(tarray* const*) data;
 			case type::i1:
 				return *(const bool*) data;
 			case type::i8:
@@ -258,6 +274,8 @@ namespace li {
 			case type::fn:
 			case type::str:
 			case type::vcl:
+			case type::omap:
+			case type::tarr:
 				LI_ASSERT(to_type(type()) == t);
 				*(gc::header**) data = as_gc();
 				break;